@@ -0,0 +1,117 @@
+// Global value numbering on the SSA form: redundant computations are replaced by the
+// earlier temp holding the same value, copies are propagated or folded into the
+// instruction computing their source, and computations nobody reads are removed.
+#include <unordered_map>
+
+// Hash key of a pure instruction, with the operands of commutative operators sorted.
+static std::string valueKey(const Instruction &inst) {
+    if (inst.kind == Instruction::Const) return "#" + inst.op;
+    std::vector<std::string> args = inst.args;
+    if (inst.kind == Instruction::Binary && args.size() == 2 && args[1] < args[0] &&
+        (inst.op == "+" || inst.op == "*" || inst.op == "=="))
+        std::swap(args[0], args[1]);
+    std::string key = inst.op;
+    for (const std::string &arg : args) key += " " + arg;
+    return key;
+}
+
+// Runs value numbering over every method in SSA form and returns the number of
+// instructions removed. Walking the dominator tree with a scoped table means a value
+// is only reused where the instruction computing it dominates the reuse.
+int IR::numberValues() {
+    int total = 0;
+    for (Function* function : functions) {
+        if (!function->inSSA) continue;
+        computePredecessors(function);
+        computeDominators(function);
+        int removed = 0;
+
+        std::unordered_map<std::string, std::string> replacement;  // Removed name -> name with its value.
+        auto resolve = [&](std::string name) {
+            for (auto it = replacement.find(name); it != replacement.end(); it = replacement.find(name))
+                name = it->second;
+            return name;
+        };
+        auto readsField = [&](const Instruction &inst) {
+            return std::any_of(inst.args.begin(), inst.args.end(), [&](const std::string &arg) { return function->isField(arg); });
+        };
+
+        std::unordered_map<std::string, std::string> available;    // Value key -> temp holding it.
+        struct ScopeFrame { BasicBlock* block; size_t nextChild; std::vector<std::string> keys; };
+        std::vector<ScopeFrame> stack;
+        stack.push_back({function->entry(), 0, {}});
+        bool entering = true;
+        while (!stack.empty()) {
+            ScopeFrame &frame = stack.back();
+            if (entering) {
+                // Returns true when the instruction is redundant and can be dropped.
+                auto redundant = [&](Instruction &inst) {
+                    if (inst.kind != Instruction::Phi)
+                        for (std::string &arg : inst.args) arg = resolve(arg);
+                    bool pure = inst.kind == Instruction::Const || inst.kind == Instruction::Unary ||
+                                inst.kind == Instruction::Binary || inst.kind == Instruction::Copy;
+                    if (!pure || function->isField(inst.dst) || readsField(inst)) return false;
+
+                    // A temp copied from another value is just another name for it.
+                    if (inst.kind == Instruction::Copy) {
+                        if (!isTempName(inst.dst)) return false;
+                        replacement[inst.dst] = inst.args[0];
+                        return true;
+                    }
+                    std::string key = valueKey(inst);
+                    auto found = available.find(key);
+                    if (found != available.end()) {
+                        replacement[inst.dst] = found->second;
+                        return true;
+                    }
+                    available[key] = inst.dst;
+                    frame.keys.push_back(key);
+                    return false;
+                };
+                removed += frame.block->removeInstructions(redundant);
+            }
+            if (frame.nextChild < frame.block->domChildren.size()) {
+                BasicBlock* child = frame.block->domChildren[frame.nextChild++];
+                stack.push_back({child, 0, {}});
+                entering = true;
+                continue;
+            }
+            for (const std::string &key : frame.keys) available.erase(key);
+            stack.pop_back();
+            entering = false;
+        }
+
+        // Phi operands flowing in over back edges are only known now.
+        std::unordered_map<std::string, int> uses;
+        for (BasicBlock* block : function->blocks)
+            for (Instruction &inst : block->instructions)
+                for (std::string &arg : inst.args) {
+                    arg = resolve(arg);
+                    uses[arg]++;
+                }
+
+        // "$t9 = a + b; x.3 = $t9" becomes "x.3 = a + b" when the copy is the temp's only use.
+        for (BasicBlock* block : function->blocks) {
+            Instruction* previous = nullptr;  // The last instruction kept so far.
+            removed += block->removeInstructions([&](Instruction &inst) {
+                if (previous && inst.kind == Instruction::Copy && !function->isField(inst.dst) && !isTempName(inst.dst)) {
+                    const std::string &source = inst.args[0];
+                    if (isTempName(source) && uses[source] == 1 && previous->dst == source) {
+                        uses[source] = 0;
+                        previous->dst = inst.dst;
+                        if (previous->note.empty()) previous->note = inst.note;
+                        return true;
+                    }
+                }
+                previous = &inst;
+                return false;
+            });
+        }
+
+        removed += removeDeadValues(function, false);
+
+        function->optCounts["gvn_removed"] += removed;
+        total += removed;
+    }
+    return total;
+}
@@ -6,9 +6,11 @@
 #include <string>
 #include <set>
 #include <algorithm>
-#include <regex>
+#include <map>
+#include <unordered_map>
 #include <queue>
 #include <iomanip>
+#include <cstdlib>
 
 std::string cleanType(const std::string &s) {
     if (!s.empty() && s.back() == ':')
@@ -38,10 +40,31 @@ std::string getNodeValue(Node* node) {
      return cleanType(node->type);
 }
 
+class BasicBlock;
+
+// One three-address instruction. Operands are kept apart so passes and the bytecode
+// generator never have to parse the printed form.
 class Instruction {
 public:
-    std::string text;
-    Instruction(const std::string &t) : text(t) {}
+    enum Kind { Const, Copy, Unary, Binary, Call, New, Print, IfFalse, Goto, Return, Stop, Comment, Phi };
+
+    Kind kind;
+    std::string dst;                // Variable written, empty if none.
+    std::string op;                 // Operator, literal value, method or class name, or comment text.
+    std::vector<std::string> args;  // Variables read; the receiver comes first for calls.
+    BasicBlock* target;             // Jump target of IfFalse and Goto.
+    std::vector<BasicBlock*> sources;  // Phi only: the predecessor each argument flows in from.
+    std::string note;               // Trailing comment in the printed form.
+    int line = 0;                   // Source line it was generated for, 0 if unknown.
+    int method = -1;                // Call only: the callee's index in IR::functions, from semantic analysis.
+
+    Instruction(Kind kind, const std::string &dst = "", const std::string &op = "",
+                const std::vector<std::string> &args = {}, BasicBlock* target = nullptr,
+                const std::string &note = "")
+        : kind(kind), dst(dst), op(op), args(args), target(target), note(note) {}
+
+    bool isTerminator() const { return kind == IfFalse || kind == Goto || kind == Return || kind == Stop; }
+    std::string text() const;
 };
 
 class BasicBlock {
@@ -49,6 +72,15 @@ public:
     int id;
     std::vector<Instruction> instructions;
     std::vector<BasicBlock*> successors;
+    std::vector<BasicBlock*> predecessors;  // Filled in by IR::computePredecessors.
+
+    // Dominator tree, filled in by IR::computeDominators.
+    BasicBlock* idom = nullptr;
+    std::vector<BasicBlock*> domChildren;
+    std::vector<BasicBlock*> frontier;
+    int rpoIndex = -1;                      // Position in reverse postorder, -1 if unreachable.
+    int domPre = 0, domPost = 0;            // Dominator tree DFS interval.
+    std::set<std::string> liveIn, liveOut;  // Filled in by IR::computeLiveness.
 
     BasicBlock(int id) : id(id) {}
 
@@ -59,20 +91,95 @@ public:
     void addSuccessor(BasicBlock* succ) {
         successors.push_back(succ);
     }
+
+    // Drops, in one linear pass, the instructions for which drop(inst) returns true.
+    // drop may rewrite the instruction it is given, and instructions it kept earlier
+    // stay where they are. Returns how many were dropped.
+    template <class Predicate>
+    size_t removeInstructions(Predicate drop) {
+        size_t kept = 0;
+        for (size_t i = 0; i < instructions.size(); i++) {
+            if (kept != i) instructions[kept] = std::move(instructions[i]);
+            if (!drop(instructions[kept])) kept++;
+        }
+        size_t dropped = instructions.size() - kept;
+        instructions.erase(instructions.begin() + kept, instructions.end());
+        return dropped;
+    }
     std::string getCfgLabel() const;
 };
 
+std::string Instruction::text() const {
+    std::string t;
+    switch (kind) {
+        case Const:   t = dst + " = " + op + ";"; break;
+        case Copy:    t = dst + " = " + args[0] + ";"; break;
+        case Unary:   t = dst + " = " + op + args[0] + ";"; break;
+        case Binary:  t = dst + " = " + args[0] + " " + op + " " + args[1] + ";"; break;
+        case Call:
+        case Phi: {
+            t = dst + (kind == Call ? " = call " + args[0] + "." + op + "(" : " = phi(");
+            for (size_t i = (kind == Call ? 1 : 0); i < args.size(); i++)
+                t += args[i] + (i + 1 < args.size() ? ", " : "");
+            t += ");";
+            break;
+        }
+        case New:     t = dst + " = new " + op + ";"; break;
+        case Print:   t = "print " + args[0] + ";"; break;
+        case IfFalse: t = "iffalse " + args[0] + " goto block_" + std::to_string(target->id) + ";"; break;
+        case Goto:    t = "goto block_" + std::to_string(target->id) + ";"; break;
+        case Return:  t = "ireturn " + args[0] + ";"; break;
+        case Stop:    t = "stop;"; break;
+        case Comment: t = "// " + op; break;
+    }
+    if (!note.empty()) t += " // " + note;
+    return t;
+}
+
+// Temps hold one value each; results of "&&" and "||" are temps too, but get versions in SSA form.
+// They are named "$t<N>", which the lexer never produces, so no identifier of the program can
+// be taken for one.
+static bool isTempName(const std::string &name) {
+    return name.compare(0, 2, "$t") == 0 && name.find('.') == std::string::npos;
+}
+
+// The CFG of main or of one method. Blocks are owned by the IR; the entry block comes first.
+class Function {
+public:
+    std::string name;                 // "main" or "Class.method".
+    std::vector<std::string> params;
+    std::set<std::string> locals;     // Parameters and local variables; other identifiers are fields.
+    std::vector<BasicBlock*> blocks;
+    bool inSSA = false;
+    std::map<std::string, int> optCounts;  // Work done per optimisation, for --opt-report.
+    std::unordered_map<std::string, int> slots;  // Frame slot of each parameter, local and temp, see slots.cc.
+
+    Function(const std::string &name) : name(name) {}
+    BasicBlock* entry() const { return blocks.front(); }
+
+    // Names that are neither temps, locals nor SSA versions denote fields of 'this'.
+    bool isField(const std::string &name) const {
+        return name != "this" && name.compare(0, 2, "$t") != 0 && name.find('.') == std::string::npos && !locals.count(name);
+    }
+};
+
 class IR {
 public:
     std::vector<BasicBlock*> blocks;
+    std::vector<Function*> functions;      // main first, then every method in source order.
+    std::map<std::string, std::vector<std::string>> classFields;  // Fields of every class, in declaration order.
     BasicBlock* currentBlock = nullptr;
+    Function* currentFunction = nullptr;
+    std::string currentClass;
     int blockCounter = 0;
     int tempCounter = 0;
+    int currentLine = 0;                   // Source line of the node being generated.
     bool errorOccurred = false;
 
     IR() {}
     ~IR() {
         for (auto block : blocks) delete block;
+        for (auto function : functions) delete function;
     }
 
     BasicBlock* getCurrentBlock() {
@@ -83,53 +190,138 @@ public:
         return currentBlock;
     }
 
-    BasicBlock* createBlock() {
+    // Creates a block in the given function, or in the one being generated.
+    BasicBlock* createBlock(Function* function = nullptr) {
         auto *b = new BasicBlock(blockCounter++);
         blocks.push_back(b);
+        if (!function) function = currentFunction;
+        if (function) function->blocks.push_back(b);
         return b;
     }
 
-    std::string newTemp() { return "_t" + std::to_string(tempCounter++); }
+    Function* createFunction(const std::string &name) {
+        currentFunction = new Function(name);
+        functions.push_back(currentFunction);
+        currentBlock = createBlock();
+        return currentFunction;
+    }
+
+    std::string newTemp() { return "$t" + std::to_string(tempCounter++); }
 
-    void addInstruction(const std::string& instructionText) {
+    void addInstruction(const Instruction& instruction) {
          if (errorOccurred) return;
          BasicBlock* cb = getCurrentBlock();
          if (!cb) { errorOccurred = true; return; }
-         cb->addInstruction(Instruction(instructionText));
+         cb->addInstruction(instruction);
+         if (!cb->instructions.back().line) cb->instructions.back().line = currentLine;
     }
 
-    std::string genExp(Node* node) {
-        if (errorOccurred) return "";
-        if (!node) { errorOccurred = true; return ""; }
+    // Ends the current block with a jump to 'target'.
+    void addJump(BasicBlock* target, const std::string &note = "") {
+        addInstruction(Instruction(Instruction::Goto, "", "", {}, target, note));
+        if (currentBlock) currentBlock->addSuccessor(target);
+    }
+
+    // True when the block already ends in a jump or return, so it needs no fall-through goto.
+    bool endsInJump(BasicBlock* block) {
+        if (block->instructions.empty()) return false;
+        Instruction::Kind last = block->instructions.back().kind;
+        return last == Instruction::Goto || last == Instruction::IfFalse || last == Instruction::Return;
+    }
+
+    static bool isBinaryExpression(const std::string& type) {
+        return type == "addExpression" || type == "subExpression" || type == "multExpression" ||
+               type == "lessThan" || type == "greaterThan" ||
+               type == "isEqualExpression" ||
+               type == "andExpression" || type == "orExpression";
+    }
 
+    // Appends the argument expressions of a call in source order. The list nests to the left,
+    // e.g. argumentList(argumentList(argument(a), b), c), so its spine is walked bottom-up.
+    void collectArguments(Node* argNode, std::vector<Node*>& args) {
+        std::vector<Node*> reversed;
+        while (argNode) {
+            std::string argNodeType = argNode->type;
+            if (argNodeType == "argumentList") {
+                reversed.push_back(getChild(argNode, 1));
+                argNode = getChild(argNode, 0);
+            } else if (argNodeType == "argument") {
+                reversed.push_back(getChild(argNode, 0));
+                break;
+            } else if (argNodeType == "non_empty_argument_list") {
+                if (argNode->children.size() > 1) reversed.push_back(getChild(argNode, 1));
+                argNode = getChild(argNode, 0);
+            } else {
+                if (argNodeType != "noArguments")
+                    std::cerr << "Warning: Unexpected node type in argument list processing: " << argNodeType << std::endl;
+                break;
+            }
+        }
+        args.insert(args.end(), reversed.rbegin(), reversed.rend());
+    }
+
+    // Generates code for an expression without operands. Returns false if the node has operands
+    // that must be evaluated first; otherwise 'result' holds the variable naming its value.
+    bool genLeafExp(Node* node, std::string& result) {
         std::string type = node->type;
-        std::string temp;
 
+        if (isBinaryExpression(type) || type == "notExpression" || type == "methodCall") {
+            return false;
+        }
         if (type == "intLiteral" || type == "true" || type == "false") {
-            temp = newTemp();
-            addInstruction(temp + " = " + getNodeValue(node) + "; // literal " + type);
-            return temp;
+            result = newTemp();
+            addInstruction(Instruction(Instruction::Const, result, getNodeValue(node), {}, nullptr, "literal " + type));
+            return true;
         }
         if (type == "Identifier") {
-            return getNodeValue(node);
+            result = getNodeValue(node);
+            return true;
         }
          if (type == "This") {
-             return "this";
+             result = "this";
+             return true;
+         }
+        if (type == "newID") {
+             Node* classNameIdentNode = getChild(node, 0);
+             if (!classNameIdentNode || classNameIdentNode->type != "Identifier") {
+                  std::cerr << "ERROR: Expected Identifier node for class name in newID." << std::endl;
+                  errorOccurred = true; return true;
+             }
+             std::string className = getNodeValue(classNameIdentNode);
+             result = newTemp();
+             addInstruction(Instruction(Instruction::New, result, className));
+             return true;
+        }
+
+         if (type == "AllocateIdentifier" || type == "lengthMethod" || type == "newInt") {
+             std::cerr << "ERROR: arrays are not supported by code generation ('" << type << "' at line " << node->lineno << ")" << std::endl;
+             errorOccurred = true; return true;
          }
 
+        std::cerr << "ERROR: Unhandled node type in genExp: '" << type << "'" << std::endl;
+        errorOccurred = true;
+        return true;
+    }
+
+    // Emits the instruction combining the already evaluated operands of an expression node.
+    std::string genOperatorExp(Node* node, const std::string* operands, size_t operandCount) {
+        std::string type = node->type;
+        std::string temp = newTemp();
+
         if (type == "notExpression") {
-            std::string operand_var = genExp(getChild(node, 0));
-             if (errorOccurred || operand_var.empty()) { errorOccurred = true; return ""; }
-            temp = newTemp();
-            addInstruction(temp + " = !" + operand_var + ";");
-            return temp;
+            addInstruction(Instruction(Instruction::Unary, temp, "!", {operands[0]}));
         }
-
-        if (type == "addExpression" || type == "subExpression" || type == "multExpression" ||
-            type == "lessThan" || type == "greaterThan" ||
-            type == "isEqualExpression" ||
-            type == "andExpression" || type == "orExpression")
-        {
+        else if (type == "methodCall") {
+            std::string methodName = getNodeValue(getChild(node, 1));
+            Instruction call(Instruction::Call, temp, methodName, std::vector<std::string>(operands, operands + operandCount));
+            call.method = node->methodId;
+            if (call.method < 0) {
+                std::cerr << "ERROR: Call to '" << methodName << "' was not resolved by semantic analysis." << std::endl;
+                errorOccurred = true;
+            }
+            addInstruction(call);
+        }
+        else {
             std::string op_symbol;
             if (type == "addExpression") op_symbol = "+";
             else if (type == "subExpression") op_symbol = "-";
@@ -137,259 +329,391 @@ public:
             else if (type == "lessThan") op_symbol = "<";
             else if (type == "greaterThan") op_symbol = ">";
             else if (type == "isEqualExpression") op_symbol = "==";
-            else if (type == "andExpression") op_symbol = "&&";
-            else if (type == "orExpression") op_symbol = "||";
-
-            std::string left_var = genExp(getChild(node, 0));
-            if (errorOccurred || left_var.empty()) { errorOccurred = true; return ""; }
-
-            std::string right_var = genExp(getChild(node, 1));
-             if (errorOccurred || right_var.empty()) { errorOccurred = true; return ""; }
-
-            temp = newTemp();
-            addInstruction(temp + " = " + left_var + " " + op_symbol + " " + right_var + ";");
-            return temp;
+            addInstruction(Instruction(Instruction::Binary, temp, op_symbol, {operands[0], operands[1]}));
         }
+        return temp;
+    }
 
-        if (type == "methodCall") {
-            Node* objNode = getChild(node, 0);
-            Node* methodNameIdentNode = getChild(node, 1);
-            Node* argListNode = getChild(node, 2);
+    // Generates TAC for an expression and returns the variable holding its value.
+    // Operands are evaluated left to right with explicit stacks rather than recursion,
+    // so long chains such as "a + b + c + ..." are handled at any depth.
+    // "a && b" and "a || b" only evaluate b when a does not decide the result: the
+    // result variable is assigned on both paths and read where they join.
+    std::string genExp(Node* node) {
+        if (errorOccurred) return "";
 
-            if (!methodNameIdentNode || methodNameIdentNode->type != "Identifier") {
-                 std::cerr << "ERROR: Expected Identifier node for method name in methodCall." << std::endl;
-                 errorOccurred = true; return "";
+        // Stage 0: not yet expanded. Stage 1: operands done, or the left side of a short
+        // circuit operator. Stage 2: the right side of a short circuit operator is done.
+        struct ExpFrame { Node* node; int stage; size_t operandCount; BasicBlock* join; std::string result; };
+        std::vector<ExpFrame> work;       // Expressions still to generate, next one last.
+        std::vector<std::string> values;  // Variables of the evaluated operands, innermost last.
+        std::vector<Node*> operands;
+        work.push_back({node, 0, 0, nullptr, ""});
+
+        while (!work.empty()) {
+            ExpFrame frame = work.back();
+            work.pop_back();
+            if (!frame.node) { errorOccurred = true; return ""; }
+            currentLine = frame.node->lineno;
+            bool shortCircuit = frame.node->type == "andExpression" || frame.node->type == "orExpression";
+
+            if (shortCircuit && frame.stage == 0) {
+                work.push_back({frame.node, 1, 0, nullptr, ""});
+                work.push_back({getChild(frame.node, 0), 0, 0, nullptr, ""});
+                continue;
             }
-
-            std::string object_var = genExp(objNode);
-             if (errorOccurred || object_var.empty()) { errorOccurred = true; return ""; }
-
-            std::string methodName = getNodeValue(methodNameIdentNode);
-
-            std::vector<std::string> argVars;
-            std::function<void(Node*)> processArgs =
-                [&](Node* argNode) {
-                if (!argNode || errorOccurred) return;
-                std::string argNodeType = argNode->type;
-                if (argNodeType == "argumentList") {
-                    processArgs(getChild(argNode, 0));
-                    std::string argVar = genExp(getChild(argNode, 1));
-                    if (errorOccurred || argVar.empty()) { errorOccurred = true; return; }
-                    argVars.push_back(argVar);
-                } else if (argNodeType == "argument") {
-                    std::string argVar = genExp(getChild(argNode, 0));
-                     if (errorOccurred || argVar.empty()) { errorOccurred = true; return; }
-                     argVars.push_back(argVar);
-                } else if (argNodeType == "non_empty_argument_list") {
-                      processArgs(getChild(argNode, 0));
-                      if(argNode->children.size() > 1) {
-                          std::string argVar = genExp(getChild(argNode, 1));
-                          if (errorOccurred || argVar.empty()) { errorOccurred = true; return; }
-                          argVars.push_back(argVar);
-                      }
-                 } else if (argNodeType != "noArguments") {
-                    std::cerr << "Warning: Unexpected node type in argument list processing: " << argNodeType << std::endl;
+            if (shortCircuit && frame.stage == 1) {
+                std::string lhs = values.back();
+                values.pop_back();
+                // Assigned on two paths, so the result is a variable of the method rather than a temp.
+                std::string result = newTemp();
+                if (currentFunction) currentFunction->locals.insert(result);
+                addInstruction(Instruction(Instruction::Copy, result, "", {lhs}, nullptr, "short circuit"));
+                BasicBlock* from = getCurrentBlock();
+                BasicBlock* rhsB = createBlock();
+                BasicBlock* joinB = createBlock();
+                if (frame.node->type == "andExpression") {
+                    from->addInstruction(Instruction(Instruction::IfFalse, "", "", {lhs}, joinB));
+                    from->addSuccessor(rhsB);
+                    from->addSuccessor(joinB);
+                } else {
+                    from->addInstruction(Instruction(Instruction::IfFalse, "", "", {lhs}, rhsB));
+                    from->addSuccessor(joinB);
+                    from->addSuccessor(rhsB);
                 }
-            };
+                currentBlock = rhsB;
+                work.push_back({frame.node, 2, 0, joinB, result});
+                work.push_back({getChild(frame.node, 1), 0, 0, nullptr, ""});
+                continue;
+            }
+            if (shortCircuit) {
+                addInstruction(Instruction(Instruction::Copy, frame.result, "", {values.back()}, nullptr, "short circuit"));
+                values.back() = frame.result;
+                addJump(frame.join);
+                currentBlock = frame.join;
+                continue;
+            }
 
-            processArgs(argListNode);
-            if (errorOccurred) return "";
+            if (frame.stage == 1) {
+                std::string temp = genOperatorExp(frame.node, &values[values.size() - frame.operandCount], frame.operandCount);
+                values.resize(values.size() - frame.operandCount);
+                values.push_back(temp);
+                continue;
+            }
 
-            std::ostringstream call_args_ss;
-             for (size_t i = 0; i < argVars.size(); ++i) {
-                 call_args_ss << argVars[i] << (i + 1 < argVars.size() ? ", " : "");
-             }
+            std::string leaf;
+            if (genLeafExp(frame.node, leaf)) {
+                // An operand without a value poisons the enclosing expression.
+                if (errorOccurred || leaf.empty()) {
+                    if (!work.empty()) errorOccurred = true;
+                    return "";
+                }
+                values.push_back(leaf);
+                continue;
+            }
 
-            temp = newTemp();
-            addInstruction(temp + " = call " + object_var + "." + methodName + "(" + call_args_ss.str() + ");");
-            return temp;
-        }
-        if (type == "newID") {
-             Node* classNameIdentNode = getChild(node, 0);
-             if (!classNameIdentNode || classNameIdentNode->type != "Identifier") {
-                  std::cerr << "ERROR: Expected Identifier node for class name in newID." << std::endl;
-                  errorOccurred = true; return "";
-             }
-             std::string className = getNodeValue(classNameIdentNode);
-             temp = newTemp();
-             addInstruction(temp + " = new " + className + ";");
-             return temp;
+            operands.clear();
+            if (frame.node->type == "methodCall") {
+                Node* methodNameIdentNode = getChild(frame.node, 1);
+                if (!methodNameIdentNode || methodNameIdentNode->type != "Identifier") {
+                     std::cerr << "ERROR: Expected Identifier node for method name in methodCall." << std::endl;
+                     errorOccurred = true; return "";
+                }
+                operands.push_back(getChild(frame.node, 0));
+                collectArguments(getChild(frame.node, 2), operands);
+            } else {
+                operands.push_back(getChild(frame.node, 0));
+                if (frame.node->type != "notExpression")
+                    operands.push_back(getChild(frame.node, 1));
+            }
+            work.push_back({frame.node, 1, operands.size(), nullptr, ""});
+            for (auto it = operands.rbegin(); it != operands.rend(); ++it)
+                work.push_back({*it, 0, 0, nullptr, ""});
         }
-
-         if (type == "AllocateIdentifier" || type == "lengthMethod" || type == "newInt") {
-             std::cerr << "Warning: IR Generation for type '" << type << "' is not implemented." << std::endl;
-             return "";
-         }
-
-        std::cerr << "ERROR: Unhandled node type in genExp: '" << type << "'" << std::endl;
-        errorOccurred = true;
-        return "";
+        return values.back();
     }
 
-     void genStmt(Node* node) {
-         if (errorOccurred) return;
-         if (!node) return;
-
-         std::string type = node->type;
-
-         if (type == "assign") {
-              Node* lhsIdentNode = getChild(node, 0);
-              if (!lhsIdentNode || lhsIdentNode->type != "Identifier") { errorOccurred = true; return;}
-              std::string lhs_var = getNodeValue(lhsIdentNode);
+    // Generates a condition as branches: control reaches onTrue when it holds and onFalse
+    // otherwise. "&&", "||" and "!" become jumps between blocks instead of values, so
+    // no boolean is materialised for them; other expressions end in an iffalse.
+    bool genCond(Node* node, BasicBlock* onTrue, BasicBlock* onFalse) {
+        // The block a part starts in, when it is not the one generated last.
+        struct CondFrame { Node* node; BasicBlock* onTrue; BasicBlock* onFalse; BasicBlock* start; };
+        std::vector<CondFrame> work;
+        work.push_back({node, onTrue, onFalse, nullptr});
+
+        while (!work.empty()) {
+            CondFrame frame = work.back();
+            work.pop_back();
+            if (!frame.node) { errorOccurred = true; return false; }
+            currentLine = frame.node->lineno;
+            if (frame.start) currentBlock = frame.start;
+            const std::string &type = frame.node->type;
+
+            if (type == "andExpression") {
+                BasicBlock* rhsB = createBlock();
+                work.push_back({getChild(frame.node, 1), frame.onTrue, frame.onFalse, rhsB});
+                work.push_back({getChild(frame.node, 0), rhsB, frame.onFalse, nullptr});
+            }
+            else if (type == "orExpression") {
+                BasicBlock* rhsB = createBlock();
+                work.push_back({getChild(frame.node, 1), frame.onTrue, frame.onFalse, rhsB});
+                work.push_back({getChild(frame.node, 0), frame.onTrue, rhsB, nullptr});
+            }
+            else if (type == "notExpression") {
+                work.push_back({getChild(frame.node, 0), frame.onFalse, frame.onTrue, nullptr});
+            }
+            else {
+                std::string value = genExp(frame.node);
+                if (errorOccurred || value.empty()) return false;
+                BasicBlock* from = getCurrentBlock();
+                from->addInstruction(Instruction(Instruction::IfFalse, "", "", {value}, frame.onFalse));
+                from->addSuccessor(frame.onTrue);
+                from->addSuccessor(frame.onFalse);
+            }
+        }
+        return true;
+    }
 
-              std::string rhs_var = genExp(getChild(node, 1));
-              if (errorOccurred || rhs_var.empty()) { errorOccurred = true; return; }
-              addInstruction(lhs_var + " = " + rhs_var + "; // assign");
-         }
-         else if (type == "printMethod") {
-             std::string exp_var = genExp(getChild(node, 0));
-              if (errorOccurred || exp_var.empty()) { errorOccurred = true; return; }
-             addInstruction("print " + exp_var + ";");
-         }
-         else if (type == "if") {
-             std::string cond_var = genExp(getChild(node, 0));
-             if (errorOccurred || cond_var.empty()) { errorOccurred = true; return; }
-
-             BasicBlock* currentBlockBeforeIf = getCurrentBlock();
-             BasicBlock* thenB = createBlock();
-             Node* elseHandlerNode = getChild(node, 2);
-             Node* elseStmtNode = nullptr;
-             bool hasElse = (elseHandlerNode && elseHandlerNode->type == "elseBranch");
-             if (hasElse) {
-                 elseStmtNode = getChild(elseHandlerNode, 0);
+    // A statement part-way through generation: the stage to resume at once the child
+    // statement pushed above it is done, and the blocks created for it.
+    struct StmtFrame {
+        Node* node;
+        int stage;
+        BasicBlock* first;
+        BasicBlock* second;
+        BasicBlock* third;
+    };
+
+     // Generates TAC for a statement subtree. Nested statements are kept on an explicit
+     // work list, so deeply nested blocks and long statement lists cannot overflow the stack.
+     void genStmt(Node* root) {
+         std::vector<StmtFrame> work;
+         work.push_back({root, 0, nullptr, nullptr, nullptr});
+
+         while (!work.empty() && !errorOccurred) {
+             StmtFrame frame = work.back();
+             work.pop_back();
+             Node* node = frame.node;
+             if (!node) continue;
+             currentLine = node->lineno;
+
+             std::string type = node->type;
+
+             if (type == "assign") {
+                  Node* lhsIdentNode = getChild(node, 0);
+                  if (!lhsIdentNode || lhsIdentNode->type != "Identifier") { errorOccurred = true; return;}
+                  std::string lhs_var = getNodeValue(lhsIdentNode);
+
+                  std::string rhs_var = genExp(getChild(node, 1));
+                  if (errorOccurred || rhs_var.empty()) { errorOccurred = true; return; }
+                  addInstruction(Instruction(Instruction::Copy, lhs_var, "", {rhs_var}, nullptr, "assign"));
+             }
+             else if (type == "printMethod") {
+                 std::string exp_var = genExp(getChild(node, 0));
+                  if (errorOccurred || exp_var.empty()) { errorOccurred = true; return; }
+                 addInstruction(Instruction(Instruction::Print, "", "", {exp_var}));
              }
+             else if (type == "if" && frame.stage == 0) {
+                 BasicBlock* thenB = createBlock();
+                 Node* elseHandlerNode = getChild(node, 2);
+                 bool hasElse = (elseHandlerNode && elseHandlerNode->type == "elseBranch");
 
-             BasicBlock* elseB = hasElse ? createBlock() : nullptr;
-             BasicBlock* joinB = createBlock();
+                 BasicBlock* elseB = hasElse ? createBlock() : nullptr;
+                 BasicBlock* joinB = createBlock();
 
-             currentBlockBeforeIf->addInstruction(Instruction("iffalse " + cond_var + " goto block_" + std::to_string(hasElse ? elseB->id : joinB->id) + ";"));
-             currentBlockBeforeIf->addSuccessor(thenB);
-             currentBlockBeforeIf->addSuccessor(hasElse ? elseB : joinB);
+                 if (!genCond(getChild(node, 0), thenB, hasElse ? elseB : joinB)) { errorOccurred = true; return; }
 
-             currentBlock = thenB;
-             genStmt(getChild(node, 1));
-             if (!errorOccurred) {
-                 if (currentBlock && (currentBlock->instructions.empty() || !std::regex_search(currentBlock->instructions.back().text, std::regex("goto|return")))) {
-                    addInstruction("goto block_" + std::to_string(joinB->id) + ";");
-                 }
-                 if(currentBlock) currentBlock->addSuccessor(joinB);
+                 currentBlock = thenB;
+                 work.push_back({node, 1, thenB, elseB, joinB});
+                 work.push_back({getChild(node, 1), 0, nullptr, nullptr, nullptr});
              }
+             else if (type == "if") {
+                 // Stage 1: the then branch is done. Stage 2: the else branch is done.
+                 BasicBlock* elseB = frame.second;
+                 BasicBlock* joinB = frame.third;
+                 if (currentBlock && !endsInJump(currentBlock)) {
+                    addJump(joinB);
+                 }
 
-             if (hasElse && elseStmtNode) {
-                 currentBlock = elseB;
-                 genStmt(elseStmtNode);
-                 if (!errorOccurred) {
-                     if (currentBlock && (currentBlock->instructions.empty() || !std::regex_search(currentBlock->instructions.back().text, std::regex("goto|return")))) {
-                          addInstruction("goto block_" + std::to_string(joinB->id) + ";");
-                     }
-                     if(currentBlock) currentBlock->addSuccessor(joinB);
+                 Node* elseStmtNode = nullptr;
+                 if (frame.stage == 1 && elseB) {
+                     elseStmtNode = getChild(getChild(node, 2), 0);
+                 }
+                 if (elseStmtNode) {
+                     currentBlock = elseB;
+                     work.push_back({node, 2, frame.first, elseB, joinB});
+                     work.push_back({elseStmtNode, 0, nullptr, nullptr, nullptr});
+                 } else {
+                     currentBlock = joinB;
                  }
              }
+             else if (type == "while" && frame.stage == 0) {
+                 BasicBlock* condB = createBlock();
+                 BasicBlock* bodyB = createBlock();
+                 BasicBlock* exitB = createBlock();
+                 BasicBlock* currentBlockBeforeWhile = getCurrentBlock();
+
+                 if (currentBlockBeforeWhile && !endsInJump(currentBlockBeforeWhile)) {
+                     addJump(condB);
+                 }
 
-             currentBlock = joinB;
-         }
-         else if (type == "while") {
-             BasicBlock* condB = createBlock();
-             BasicBlock* bodyB = createBlock();
-             BasicBlock* exitB = createBlock();
-             BasicBlock* currentBlockBeforeWhile = getCurrentBlock();
-
-             if (currentBlockBeforeWhile && (currentBlockBeforeWhile->instructions.empty() || !std::regex_search(currentBlockBeforeWhile->instructions.back().text, std::regex("goto|return")))) {
-                 currentBlockBeforeWhile->addInstruction(Instruction("goto block_" + std::to_string(condB->id) + ";"));
-             }
-              if (currentBlockBeforeWhile) currentBlockBeforeWhile->addSuccessor(condB);
-
-             currentBlock = condB;
-             std::string cond_var = genExp(getChild(node, 0));
-              if (errorOccurred || cond_var.empty()) {
-                   addInstruction("goto block_" + std::to_string(exitB->id) + "; // while condition failed");
-                   if(currentBlock) currentBlock->addSuccessor(exitB);
-                   currentBlock = exitB;
-                   return;
-               }
-             addInstruction("iffalse " + cond_var + " goto block_" + std::to_string(exitB->id) + ";");
-             if(currentBlock) {
-                 currentBlock->addSuccessor(bodyB);
-                 currentBlock->addSuccessor(exitB);
-             }
+                 currentBlock = condB;
+                 if (!genCond(getChild(node, 0), bodyB, exitB)) {
+                       addJump(exitB, "while condition failed");
+                       currentBlock = exitB;
+                       continue;
+                   }
 
-             currentBlock = bodyB;
-             genStmt(getChild(node, 1));
-              if (!errorOccurred) {
-                 if (currentBlock && (currentBlock->instructions.empty() || !std::regex_search(currentBlock->instructions.back().text, std::regex("goto|return")))) {
-                     addInstruction("goto block_" + std::to_string(condB->id) + ";");
+                 currentBlock = bodyB;
+                 work.push_back({node, 1, condB, bodyB, exitB});
+                 work.push_back({getChild(node, 1), 0, nullptr, nullptr, nullptr});
+             }
+             else if (type == "while") {
+                 // The loop body is done: jump back to the condition.
+                 BasicBlock* condB = frame.first;
+                 BasicBlock* exitB = frame.third;
+                 if (currentBlock && !endsInJump(currentBlock)) {
+                     addJump(condB);
                  }
-                  if (currentBlock) currentBlock->addSuccessor(condB);
-              }
 
-             currentBlock = exitB;
-         }
-         else if (type == "block" || type == "statements" || type == "goal"
-                  || type == "mainClass" || type == "classDeclarations" || type == "classDeclaration"
-                  || type == "methodDeclarations" || type == "varDeclarations"
-                  || type == "ParameterList" || type == "Parameters" || type == "Parameter"
-                  || type == "argument_list" || type == "non_empty_argument_list" || type == "argument"
-                  || type == "elseHandler" || type == "elseBranch"
-                  || type.find("empty") != std::string::npos
-                  || type == "Type" || type == "ArrayType" || type == "boolean"
-                  || type == "IntType" || type == "floatType" || type == "charType"
-                  || type == "varOrStatements"
-                  || type == "chooseParam"
-                  )
-        {
-             for (auto child : node->children) {
-                 genStmt(child);
-                 if (errorOccurred) return;
+                 currentBlock = exitB;
              }
-         }
-          else if (type == "varDeclaration") {
-               for (auto child : node->children) { genStmt(child); if (errorOccurred) return; }
-          }
-          else if (type == "methodDeclaration") {
-               Node* methodNameIdent = getChild(node, 1);
-               if (methodNameIdent && methodNameIdent->type == "Identifier") {
-                   addInstruction("// Method Start: " + getNodeValue(methodNameIdent));
-               }
-               genStmt(getChild(node, 2));
-               genStmt(getChild(node, 3));
-               if(errorOccurred) return;
-
-               std::string return_var = genExp(getChild(node, 4));
-               if (errorOccurred || return_var.empty()) { errorOccurred = true; return; }
-               addInstruction("ireturn " + return_var + ";");
-
-               addInstruction("// Method End: " + (methodNameIdent ? getNodeValue(methodNameIdent) : ""));
-          }
-          else if (type == "array") {
-               std::cerr << "Warning: IR Generation for array assignment ('" << type << "') is not implemented." << std::endl;
-          }
-         else {
-             std::cerr << "Warning: Unhandled statement type in genStmt: '" << type << "'" << std::endl;
-              for (auto child : node->children) {
-                 genStmt(child);
-                  if (errorOccurred) return;
+             else if (type == "block" || type == "statements" || type == "goal"
+                      || type == "classDeclarations"
+                      || type == "methodDeclarations" || type == "varDeclarations" || type == "varDecleration"
+                      || type == "ParameterList" || type == "Parameters"
+                      || type == "argument_list" || type == "non_empty_argument_list" || type == "argument"
+                      || type == "elseHandler" || type == "elseBranch"
+                      || type.find("empty") != std::string::npos
+                      || type == "Type" || type == "ArrayType" || type == "boolean"
+                      || type == "IntType" || type == "floatType" || type == "charType"
+                      || type == "varOrStatements"
+                      || type == "chooseParam" || type == "noParameters"
+                      )
+            {
+                 for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+                     work.push_back({*it, 0, nullptr, nullptr, nullptr});
+             }
+              else if (type == "Identifier") {
+                   // Class and type names: nothing to generate.
+              }
+              else if (type == "mainClass" && frame.stage == 0) {
+                   createFunction("main");
+                   work.push_back({node, 1, nullptr, nullptr, nullptr});
+                   for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+                       work.push_back({*it, 0, nullptr, nullptr, nullptr});
+              }
+              else if (type == "mainClass") {
+                   if (currentBlock && !endsInJump(currentBlock))
+                       addInstruction(Instruction(Instruction::Stop, "", "", {}, nullptr, "implicit end"));
+                   currentFunction = nullptr;
+                   currentBlock = nullptr;
+              }
+              else if (type == "classDeclaration") {
+                   Node* classNameIdent = getChild(node, 0);
+                   currentClass = classNameIdent ? getNodeValue(classNameIdent) : "";
+                   for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+                       work.push_back({*it, 0, nullptr, nullptr, nullptr});
+              }
+              else if (type == "varDeclaration" || type == "Parameter") {
+                   // Fields are declared outside any method and live in the object.
+                   Node* nameIdent = getChild(node, 1);
+                   if (!currentFunction && nameIdent && type == "varDeclaration")
+                       classFields[currentClass].push_back(getNodeValue(nameIdent));
+                   if (currentFunction && nameIdent) {
+                       currentFunction->locals.insert(getNodeValue(nameIdent));
+                       if (type == "Parameter")
+                           currentFunction->params.push_back(getNodeValue(nameIdent));
+                   }
               }
+              else if (type == "methodDeclaration" && frame.stage == 0) {
+                   Node* methodNameIdent = getChild(node, 1);
+                   std::string methodName = methodNameIdent ? getNodeValue(methodNameIdent) : "";
+                   createFunction(currentClass + "." + methodName);
+                   addInstruction(Instruction(Instruction::Comment, "", "Method Start: " + methodName));
+                   work.push_back({node, 1, nullptr, nullptr, nullptr});
+                   work.push_back({getChild(node, 3), 0, nullptr, nullptr, nullptr});
+                   work.push_back({getChild(node, 2), 0, nullptr, nullptr, nullptr});
+              }
+              else if (type == "methodDeclaration") {
+                   // Parameters and body are done: return the value of the return expression.
+                   std::string return_var = genExp(getChild(node, 4));
+                   if (errorOccurred || return_var.empty()) { errorOccurred = true; return; }
+                   addInstruction(Instruction(Instruction::Return, "", "", {return_var}));
+                   currentFunction = nullptr;
+                   currentBlock = nullptr;
+              }
+              else if (type == "array") {
+                   std::cerr << "ERROR: arrays are not supported by code generation ('" << type << "' at line " << node->lineno << ")" << std::endl;
+                   errorOccurred = true; return;
+              }
+             else {
+                 std::cerr << "Warning: Unhandled statement type in genStmt: '" << type << "'" << std::endl;
+                 for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+                     work.push_back({*it, 0, nullptr, nullptr, nullptr});
+             }
          }
      }
 
     void start(Node* root);
     void printCFG(const std::string &filename);
     void generateBytecode(const std::string& filename);
+    void generateBytecode(std::ostream& out);
+
+    // Analyses and SSA construction, see SSA.cc.
+    void computePredecessors(Function* function);
+    void computeDominators(Function* function);
+    static bool dominates(const BasicBlock* a, const BasicBlock* b);
+    void computeLiveness(Function* function);
+    int removeDeadValues(Function* function, bool phisOnly);
+    void buildSSA();
+    void leaveSSA();
+
+    // Loop-invariant code motion and strength reduction, see loopOpt.cc.
+    BasicBlock* ensurePreheader(Function* function, BasicBlock* header, const std::set<BasicBlock*> &body);
+    int optimizeLoops();
+
+    // Value numbering, copy propagation and dead code removal, see GVN.cc.
+    int numberValues();
+
+    // Inlining of small methods, see inline.cc.
+    BasicBlock* inlineCall(Function* caller, BasicBlock* block, size_t index, Function* callee);
+    int inlineCalls(size_t budget);
+
+    // Self tail calls turned into jumps, see tailcall.cc.
+    int eliminateTailCalls();
+
+    // Emission order of the blocks, see layout.cc.
+    std::vector<BasicBlock*> layoutBlocks(Function* function);
+
+    // Frame slots shared by variables that are never live together, see slots.cc.
+    int allocateSlots(Function* function, const std::vector<BasicBlock*> &order);
 
 };
 
 void IR::start(Node* root) {
     errorOccurred = false;
     if (!root) { errorOccurred = true; return; }
-    if(blocks.empty()) { currentBlock = createBlock(); }
-    else { currentBlock = blocks[0]; }
     genStmt(root);
-    if (!errorOccurred && currentBlock && (currentBlock->instructions.empty() || !std::regex_search(currentBlock->instructions.back().text, std::regex("goto|return|stop|iffalse|ireturn")))) {
-        addInstruction("stop; // implicit end");
-    }
     if(errorOccurred) { std::cerr << "\n--- IR Generation Failed ---\n" << std::endl; }
 }
 
+// Writes text into a DOT label, escaping the characters DOT treats specially,
+// and returns the number of characters written.
+static size_t writeDotEscaped(std::ostream &out, const std::string &text) {
+    size_t written = 0;
+    for (char c : text) {
+        if (c == '\\' || c == '"' || c == '<' || c == '>' || c == '{' || c == '}') {
+            out << '\\';
+            written++;
+        }
+        out << c;
+        written++;
+    }
+    return written;
+}
+
 void IR::printCFG(const std::string &filename) {
          std::ofstream out(filename);
          if (!out) { return; }
@@ -397,20 +721,46 @@ void IR::printCFG(const std::string &filename) {
          out << "  rankdir=TB;\n";
          out << "  node [shape=box, fontname=\"Courier New\", fontsize=10];\n";
          out << "  edge [fontname=\"Helvetica\", fontsize=9];\n";
-         for (const auto *b : blocks) {
-             std::ostringstream labelStream; labelStream << "[Block " << b->id << "]\\n"; labelStream << std::left;
-             for(const auto& inst : b->instructions) { std::string escaped_text = inst.text; std::regex esc_chars("[\\\\\"<>{}]"); escaped_text = std::regex_replace(escaped_text, esc_chars, "\\$&"); labelStream << std::setw(30) << escaped_text << "\\l"; }
-             out << "  block_" << b->id << " [label=\"" << labelStream.str() << "\"];\n";
+         for (size_t f = 0; f < functions.size(); f++) {
+             out << "  subgraph cluster_" << f << " {\n";
+             out << "    label=\"" << functions[f]->name << "\";\n";
+             for (const auto *b : functions[f]->blocks) {
+                 out << "    block_" << b->id << " [label=\"[Block " << b->id << "]\\n";
+                 for (const auto& inst : b->instructions) {
+                     size_t width = writeDotEscaped(out, inst.text());
+                     for (; width < 30; width++) out << ' ';
+                     out << "\\l";
+                 }
+                 out << "\"];\n";
+             }
+             out << "  }\n";
          }
          std::set<std::pair<int, int>> drawn_edges;
+         auto drawEdge = [&](const BasicBlock *from, const BasicBlock *to, const char *attrs) {
+             if (!drawn_edges.insert({from->id, to->id}).second) return;
+             out << "  block_" << from->id << " -> block_" << to->id << " [" << attrs << "];\n";
+         };
          for (const auto *b : blocks) {
-              std::string trueLabel = "", falseLabel = "", gotoLabel = ""; BasicBlock* trueSucc = nullptr, *falseSucc = nullptr, *gotoSucc = nullptr; int falseTargetId = -1, gotoTargetId = -1;
-              if (!b->instructions.empty()) { const std::string& lastInst = b->instructions.back().text; std::smatch m; if (std::regex_match(lastInst, m, std::regex(R"(iffalse\s+\S+\s+goto\s+block_(\d+);?)"))) { falseTargetId = std::stoi(m[1].str()); falseLabel = "false"; trueLabel = "true"; } else if (std::regex_match(lastInst, m, std::regex(R"(goto\s+block_(\d+);?)"))) { gotoTargetId = std::stoi(m[1].str()); gotoLabel = "goto"; } }
-              for (auto* succ : b->successors) { if(!succ) continue; if (succ->id == falseTargetId) falseSucc = succ; else if (succ->id == gotoTargetId) gotoSucc = succ; else { if(falseTargetId != -1 && !trueSucc) trueSucc = succ; } }
-              if (trueSucc && drawn_edges.find({b->id, trueSucc->id}) == drawn_edges.end()) { out << "  block_" << b->id << " -> block_" << trueSucc->id << " [label=\"" << trueLabel << "\"];\n"; drawn_edges.insert({b->id, trueSucc->id}); }
-              if (falseSucc && drawn_edges.find({b->id, falseSucc->id}) == drawn_edges.end()) { out << "  block_" << b->id << " -> block_" << falseSucc->id << " [label=\"" << falseLabel << "\"];\n"; drawn_edges.insert({b->id, falseSucc->id}); }
-              if (gotoSucc && drawn_edges.find({b->id, gotoSucc->id}) == drawn_edges.end()) { out << "  block_" << b->id << " -> block_" << gotoSucc->id << " [label=\"" << gotoLabel << "\"];\n"; drawn_edges.insert({b->id, gotoSucc->id}); }
-              for (auto* succ : b->successors) { if (!succ) continue; if (succ != trueSucc && succ != falseSucc && succ != gotoSucc && drawn_edges.find({b->id, succ->id}) == drawn_edges.end()) { out << "  block_" << b->id << " -> block_" << succ->id << " [style=dashed, label=\"?\"];\n"; drawn_edges.insert({b->id, succ->id}); } }
+              BasicBlock *trueSucc = nullptr, *falseSucc = nullptr, *gotoSucc = nullptr;
+              int falseTargetId = -1, gotoTargetId = -1;
+              if (!b->instructions.empty()) {
+                  const Instruction &last = b->instructions.back();
+                  if (last.kind == Instruction::IfFalse) falseTargetId = last.target->id;
+                  else if (last.kind == Instruction::Goto) gotoTargetId = last.target->id;
+              }
+              for (auto* succ : b->successors) {
+                  if (!succ) continue;
+                  if (succ->id == falseTargetId) falseSucc = succ;
+                  else if (succ->id == gotoTargetId) gotoSucc = succ;
+                  else if (falseTargetId != -1 && !trueSucc) trueSucc = succ;
+              }
+              if (trueSucc) drawEdge(b, trueSucc, "label=\"true\"");
+              if (falseSucc) drawEdge(b, falseSucc, "label=\"false\"");
+              if (gotoSucc) drawEdge(b, gotoSucc, "label=\"goto\"");
+              for (auto* succ : b->successors) {
+                  if (succ && succ != trueSucc && succ != falseSucc && succ != gotoSucc)
+                      drawEdge(b, succ, "style=dashed, label=\"?\"");
+              }
          }
          out << "}\n";
          if (out.good()) { std::cout << "CFG written to " << filename << std::endl; }
@@ -418,38 +768,151 @@ void IR::printCFG(const std::string &filename) {
      }
 
 void IR::generateBytecode(const std::string& filename) {
-         if (errorOccurred) { std::cerr << "Skipping bytecode generation due to errors in IR phase." << std::endl; std::ofstream out(filename); out << "// BYTECODE GENERATION FAILED DUE TO IR ERRORS\nstop\n"; out.close(); return; }
          std::ofstream out(filename);
          if (!out) { std::cerr << "Error opening " << filename << std::endl; return; }
-         std::set<int> visited; std::queue<BasicBlock*> queue;
-         if (blocks.empty()) { out << "stop\n"; out.close(); std::cout << "Bytecode written (empty IR)." << std::endl; return; }
-         queue.push(blocks[0]);
-         auto emit = [&](const std::string& op, const std::string& arg = "") { out << op; if (!arg.empty()) out << " " << arg; out << "\n"; };
-
-         while (!queue.empty()) {
-             BasicBlock* block = queue.front(); queue.pop();
-             if (!block || visited.count(block->id)) continue; visited.insert(block->id);
-             out << "label block_" << block->id << ":\n";
-             for (const auto& instr : block->instructions) {
-                 std::string line = instr.text; std::smatch m;
-                 if (std::regex_match(line, m, std::regex(R"(\s*(\S+)\s*=\s*(-?\d+)\s*;\s*(?:\/\/.*)?)"))) { emit("iconst", m[2]); emit("istore", m[1]); }
-                 else if (std::regex_match(line, m, std::regex(R"(\s*(\S+)\s*=\s*!(\S+)\s*;\s*(?:\/\/.*)?)"))) { emit("iload", m[2]); emit("inot"); emit("istore", m[1]); }
-                 else if (std::regex_match(line, m, std::regex(R"(\s*(\S+)\s*=\s*(\S+)\s*([+\-*/<>=&|]{1,2})\s*(\S+)\s*;\s*(?:\/\/.*)?)"))) { std::string dst = m[1], lhs = m[2], op = m[3], rhs = m[4]; emit("iload", lhs); emit("iload", rhs); if (op == "+") emit("iadd"); else if (op == "-") emit("isub"); else if (op == "*") emit("imul"); else if (op == "/") emit("idiv"); else if (op == "<") emit("ilt"); else if (op == ">") emit("igt"); else if (op == "==") emit("ieq"); else if (op == "&&") emit("iand"); else if (op == "||") emit("ior"); else emit("// unknown binary op: " + op); emit("istore", dst); }
-                 else if (std::regex_match(line, m, std::regex(R"(\s*(\S+)\s*=\s*([a-zA-Z_][\w]*)\s*;\s*(?:\/\/.*)?)"))) { emit("iload", m[2]); emit("istore", m[1]); }
-                 else if (std::regex_match(line, m, std::regex(R"(\s*print\s+(\S+)\s*;\s*(?:\/\/.*)?)"))) { emit("iload", m[1]); emit("print"); }
-                 else if (std::regex_match(line, m, std::regex(R"(\s*iffalse\s+(\S+)\s+goto\s+(block_\d+)\s*;\s*(?:\/\/.*)?)"))) { emit("iload", m[1]); emit("iffalse goto", m[2]); }
-                 else if (std::regex_match(line, m, std::regex(R"(\s*goto\s+(block_\d+)\s*;\s*(?:\/\/.*)?)"))) { emit("goto", m[1]); }
-                 else if (std::regex_match(line, m, std::regex(R"(\s*ireturn\s+(\S+)\s*;\s*(?:\/\/.*)?)"))) { emit("iload", m[1]); emit("ireturn"); }
-                 else if (std::regex_match(line, m, std::regex(R"(\s*ireturn\s*;\s*(?:\/\/.*)?)"))) { emit("ireturn"); }
-                 else if (std::regex_match(line, m, std::regex(R"(\s*stop\s*;\s*(?:\/\/.*)?)"))) { emit("stop"); }
-                 else if (std::regex_match(line, m, std::regex(R"(\s*(\S+)\s*=\s*call\s*(\S+)\.(\S+)\((.*)\);\s*(?:\/\/.*)?)"))) { emit("// Call: " + m[1].str() + " = " + m[2].str() + "." + m[3].str() + "(" + m[4].str() + ")"); emit("iconst", "0"); emit("istore", m[1]); }
-                 else if (std::regex_match(line, m, std::regex(R"(\s*(\S+)\s*=\s*new\s+(\S+)\s*;\s*(?:\/\/.*)?)"))) { emit("// New: " + m[1].str() + " = new " + m[2].str()); emit("iconst", "0"); emit("istore", m[1]); }
-                 else { out << "// UNMATCHED IR: " << line << "\n"; }
+         generateBytecode(out);
+         out.close();
+         if (!errorOccurred) std::cout << "Bytecode written to " << filename << "\n";
+     }
+
+// Writes the bytecode of every function to 'out', main first.
+void IR::generateBytecode(std::ostream& out) {
+         if (errorOccurred) { std::cerr << "Skipping bytecode generation due to errors in IR phase." << std::endl; out << "// BYTECODE GENERATION FAILED DUE TO IR ERRORS\n.method main slots 0 params 0 stack 0\nstop\n"; return; }
+         leaveSSA();
+         if (functions.empty()) { out << ".method main slots 0 params 0 stack 0\nstop\n"; std::cout << "Bytecode written (empty IR)." << std::endl; return; }
+         // A method's code is collected first, since its header records how deep the operand
+         // stack gets. The code for each IR instruction starts and ends with an empty stack.
+         std::ostringstream code;
+         int depth = 0, maxDepth = 0;
+         auto emit = [&](const std::string& op, const std::string& arg = "") {
+             code << op; if (!arg.empty()) code << " " << arg; code << "\n";
+             int pops = 0, pushes = 0;
+             if (op == "iconst" || op == "iload" || op == "getfield" || op == "new") pushes = 1;
+             else if (op == "istore" || op == "putfield" || op == "print" || op == "ireturn") pops = 1;
+             else if (op == "iadd" || op == "isub" || op == "imul" || op == "idiv" || op == "ilt" || op == "igt" || op == "ieq") { pops = 2; pushes = 1; }
+             else if (op == "inot") { pops = 1; pushes = 1; }
+             else if (op.compare(0, 7, "if_icmp") == 0) pops = 2;
+             else if (op.compare(0, 2, "if") == 0) pops = 1;
+             else if (op == "invoke") { pops = functions[std::stoi(arg)]->params.size() + 1; pushes = 1; }
+             depth += pushes - pops;
+             maxDepth = std::max(maxDepth, depth);
+         };
+         auto label = [](const BasicBlock* target) { return "block_" + std::to_string(target->id); };
+
+         // The program is written out only once every method has been emitted, so that an
+         // error in one of them leaves nothing half written.
+         std::ostringstream program;
+
+         // main comes first, so execution starts at its entry block and ends at its stop.
+         // Jumps to the block laid out next are left out, and a branch whose false target
+         // comes next is inverted so it falls through there.
+         for (Function* function : functions) {
+             std::vector<BasicBlock*> order = layoutBlocks(function);
+             // The header gives the frame size, the number of parameters, which a call passes
+             // in the slots after the receiver's, and the operand stack depth. Variables are
+             // named by slot and the fields of 'this' by their index in the class.
+             int slotCount = allocateSlots(function, order);
+             code.str("");
+             depth = maxDepth = 0;
+             int line = 0;  // Source line of the code emitted last.
+             const std::vector<std::string> &fields = classFields[function->name.substr(0, function->name.find('.'))];
+             // Index of a field of 'this'; a name that is not one is an error.
+             auto field = [&](const std::string &name) {
+                 auto found = std::find(fields.begin(), fields.end(), name);
+                 if (found == fields.end()) {
+                     std::cerr << "ERROR: '" << name << "' in " << function->name << " is neither a variable nor a field" << std::endl;
+                     errorOccurred = true;
+                 }
+                 return std::to_string(found - fields.begin());
+             };
+             auto load = [&](const std::string &name) {
+                 if (!function->isField(name)) { emit("iload", std::to_string(function->slots.at(name))); return; }
+                 emit("getfield", field(name));
+             };
+             auto store = [&](const std::string &name) {
+                 if (!function->isField(name)) { emit("istore", std::to_string(function->slots.at(name))); return; }
+                 emit("putfield", field(name));
+             };
+             std::map<std::string, int> uses;
+             for (BasicBlock* block : order)
+                 for (const auto& instr : block->instructions)
+                     for (const std::string &arg : instr.args) uses[arg]++;
+
+             for (size_t b = 0; b < order.size(); b++) {
+                 BasicBlock* block = order[b];
+                 BasicBlock* next = b + 1 < order.size() ? order[b + 1] : nullptr;
+                 // Ends the block with a two-way branch, given the opcodes jumping when the
+                 // condition fails and when it holds.
+                 auto emitBranch = [&](const char *whenFalse, const char *whenTrue, const Instruction &branch) {
+                     BasicBlock* onTrue = block->successors[0];
+                     if (onTrue == next) { emit(whenFalse, label(branch.target)); return; }
+                     if (branch.target == next) { emit(whenTrue, label(onTrue)); return; }
+                     emit(whenFalse, label(branch.target));
+                     emit("goto", label(onTrue));
+                 };
+                 code << "label block_" << block->id << ":\n";
+                 for (size_t i = 0; i < block->instructions.size(); i++) {
+                     const Instruction &instr = block->instructions[i];
+                     const std::vector<std::string> &args = instr.args;
+                     // The code from a ".line N" up to the next one was generated for source line N.
+                     if (instr.line && instr.line != line && instr.kind != Instruction::Comment) {
+                         code << ".line " << instr.line << "\n";
+                         line = instr.line;
+                     }
+                     switch (instr.kind) {
+                         case Instruction::Const: emit("iconst", instr.op); store(instr.dst); break;
+                         case Instruction::Copy: load(args[0]); store(instr.dst); break;
+                         case Instruction::Unary: load(args[0]); emit("inot"); store(instr.dst); break;
+                         case Instruction::Binary: {
+                             const std::string &op = instr.op;
+                             load(args[0]); load(args[1]);
+                             // A comparison only read by the iffalse after it branches on the
+                             // operands directly, taking the jump when the comparison fails.
+                             const Instruction* branch = i + 1 < block->instructions.size() ? &block->instructions[i + 1] : nullptr;
+                             if (branch && branch->kind == Instruction::IfFalse && branch->args[0] == instr.dst &&
+                                 isTempName(instr.dst) && uses[instr.dst] == 1 && (op == "<" || op == ">" || op == "==")) {
+                                 if (op == "<") emitBranch("if_icmpge goto", "if_icmplt goto", *branch);
+                                 else if (op == ">") emitBranch("if_icmple goto", "if_icmpgt goto", *branch);
+                                 else emitBranch("if_icmpne goto", "if_icmpeq goto", *branch);
+                                 i++;
+                                 break;
+                             }
+                             if (op == "+") emit("iadd"); else if (op == "-") emit("isub"); else if (op == "*") emit("imul"); else if (op == "/") emit("idiv"); else if (op == "<") emit("ilt"); else if (op == ">") emit("igt"); else if (op == "==") emit("ieq"); else emit("// unknown binary op: " + op);
+                             store(instr.dst);
+                             break;
+                         }
+                         case Instruction::Print: load(args[0]); emit("print"); break;
+                         case Instruction::IfFalse: load(args[0]); emitBranch("iffalse goto", "iftrue goto", instr); break;
+                         case Instruction::Goto: if (instr.target != next) emit("goto", label(instr.target)); break;
+                         case Instruction::Return: load(args[0]); emit("ireturn"); break;
+                         case Instruction::Stop: emit("stop"); break;
+                         case Instruction::Call: {
+                             // The receiver and arguments go on the stack and the callee is named
+                             // by its index, so the VM never looks a method up by name.
+                             emit("// Call: " + instr.dst + " = " + args[0] + "." + functions[instr.method]->name);
+                             for (const std::string &arg : args) load(arg);
+                             emit("invoke", std::to_string(instr.method));
+                             store(instr.dst);
+                             break;
+                         }
+                         case Instruction::New: {
+                             auto found = classFields.find(instr.op);
+                             emit("// New: " + instr.dst + " = new " + instr.op);
+                             emit("new", std::to_string(found == classFields.end() ? 0 : found->second.size()));
+                             store(instr.dst);
+                             break;
+                         }
+                         case Instruction::Comment: emit("// " + instr.op); break;
+                         case Instruction::Phi: code << "// UNMATCHED IR: " << instr.text() << "\n"; break;
+                     }
+                 }
+                 bool fallsThrough = block->instructions.empty() || !block->instructions.back().isTerminator();
+                 if (fallsThrough && !block->successors.empty() && block->successors[0] != next)
+                     emit("goto", label(block->successors[0]));
              }
-             for (BasicBlock* succ : block->successors) { if (succ && visited.find(succ->id) == visited.end()) { queue.push(succ); } }
+             program << ".method " << function->name << " slots " << slotCount << " params " << function->params.size()
+                 << " stack " << maxDepth << "\n" << code.str();
          }
-         bool last_block_terminated = true; if (!blocks.empty() && visited.count(blocks.back()->id)) { BasicBlock* last_gen_block = blocks.back(); if (last_gen_block && (last_gen_block->instructions.empty() || !std::regex_search(last_gen_block->instructions.back().text, std::regex("goto|return|stop|iffalse|ireturn")))) { last_block_terminated = false; } } else if (blocks.empty()) { last_block_terminated = true; }
-         if (!last_block_terminated) { emit("stop"); }
-         out.close();
-         std::cout << "Bytecode written to " << filename << "\n";
+         if (errorOccurred) { std::cerr << "Bytecode generation failed." << std::endl; out << "// BYTECODE GENERATION FAILED DUE TO IR ERRORS\n.method main slots 0 params 0 stack 0\nstop\n"; return; }
+         out << program.str();
      }
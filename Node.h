@@ -2,6 +2,7 @@
 #define	NODE_H
 
 #include <list>
+#include <memory>
 #include <iostream>
 #include <fstream>
 #include <vector>
@@ -15,24 +16,34 @@ class Node {
 public:
 	int id, lineno;
 	string type, value;
+	string resolved;	// methodCall: "Class.method" of the callee, filled in by semantic analysis.
+	int methodId = -1;	// methodCall: number of the callee, main being 0 and methods following in source order.
 	list<Node*> children;
-	Node(string t, string v, int l) : type(t), value(v), lineno(l){}
+	Node(string t, string v, int l) : lineno(l), type(t), value(v){}
 	Node()
 	{
 		type = "uninitialised";
 		value = "uninitialised"; }   // Bison needs this.
   
+	// Prints the subtree with an explicit stack so that deep trees cannot overflow the call stack.
 	void print_tree(int depth=0) {
-		for(int i=0; i<depth; i++)
-		cout << "  ";
-		cout << type << ":" << value << endl; //<< " @line: "<< lineno << endl;
-		for(auto i=children.begin(); i!=children.end(); i++)
-		(*i)->print_tree(depth+1);
+		vector<pair<Node*, int>> stack;
+		stack.push_back({this, depth});
+		while (!stack.empty()) {
+			Node* node = stack.back().first;
+			int level = stack.back().second;
+			stack.pop_back();
+			for(int i=0; i<level; i++)
+			cout << "  ";
+			cout << node->type << ":" << node->value << endl; //<< " @line: "<< lineno << endl;
+			for(auto i=node->children.rbegin(); i!=node->children.rend(); i++)
+			stack.push_back({*i, level+1});
+		}
 	}
   
 	void generate_tree() {
 		std::ofstream outStream;
-		char* filename = "tree.dot";
+		const char* filename = "tree.dot";
 	  	outStream.open(filename);
 
 		int count = 0;
@@ -44,17 +55,54 @@ public:
 		printf("\nBuilt a parse-tree at %s. Use 'make tree' to generate the pdf version.\n", filename);
   	}
 
+  	// Writes the DOT nodes and edges of the subtree. Each stack entry is a node and its next
+  	// unvisited child; an edge is written once the child's own subtree is complete.
   	void generate_tree_content(int &count, ofstream *outStream) {
+	  vector<pair<Node*, list<Node*>::iterator>> stack;
 	  id = count++;
-	  *outStream << "n" << id << " [label=\"" << type << ":" << value << "\"];" << endl;
+	  *outStream << "n" << id << " [label=\"" << type << ":" << value << "\"];\n";
+	  stack.push_back({this, children.begin()});
 
-	  for (auto i = children.begin(); i != children.end(); i++)
+	  while (!stack.empty())
 	  {
-		  (*i)->generate_tree_content(count, outStream);
-		  *outStream << "n" << id << " -> n" << (*i)->id << endl;
+		  Node* node = stack.back().first;
+		  if (stack.back().second != node->children.end())
+		  {
+			  Node* child = *stack.back().second;
+			  child->id = count++;
+			  *outStream << "n" << child->id << " [label=\"" << child->type << ":" << child->value << "\"];\n";
+			  stack.push_back({child, child->children.begin()});
+			  continue;
+		  }
+		  stack.pop_back();
+		  if (!stack.empty())
+		  {
+			  *outStream << "n" << stack.back().first->id << " -> n" << node->id << '\n';
+			  ++stack.back().second;
+		  }
 	  }
   }
 
 };
 
+// Frees a subtree without recursing, so deep trees cannot overflow the call stack. Null
+// children, left where a subtree was already freed, are skipped.
+inline void deleteTree(Node* root) {
+	vector<Node*> work;
+	if (root) work.push_back(root);
+	while (!work.empty()) {
+		Node* node = work.back();
+		work.pop_back();
+		for (Node* child : node->children)
+			if (child) work.push_back(child);
+		delete node;
+	}
+}
+
+// Owns a whole tree, which deleteTree frees when the owner goes.
+struct TreeDeleter {
+	void operator()(Node* root) const { deleteTree(root); }
+};
+typedef unique_ptr<Node, TreeDeleter> TreePtr;
+
 #endif
\ No newline at end of file
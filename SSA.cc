@@ -0,0 +1,356 @@
+// Control-flow analyses over the per-method CFGs built by IR.cc, and the
+// conversion of their TAC into and out of static single assignment form.
+#include <unordered_map>
+
+void IR::computePredecessors(Function* function) {
+    for (BasicBlock* block : function->blocks) {
+        block->predecessors.clear();
+        block->rpoIndex = -1;
+    }
+
+    // Number the reachable blocks in reverse postorder with an explicit DFS.
+    std::vector<BasicBlock*> postorder;
+    std::vector<std::pair<BasicBlock*, size_t>> stack;
+    function->entry()->rpoIndex = 0;
+    stack.push_back({function->entry(), 0});
+    while (!stack.empty()) {
+        BasicBlock* block = stack.back().first;
+        size_t &next = stack.back().second;
+        if (next < block->successors.size()) {
+            BasicBlock* succ = block->successors[next++];
+            if (succ->rpoIndex == -1) {
+                succ->rpoIndex = 0;
+                stack.push_back({succ, 0});
+            }
+            continue;
+        }
+        postorder.push_back(block);
+        stack.pop_back();
+    }
+
+    // Unreachable blocks are dropped from the function; they stay owned by the IR.
+    function->blocks.assign(postorder.rbegin(), postorder.rend());
+    for (size_t i = 0; i < function->blocks.size(); i++)
+        function->blocks[i]->rpoIndex = static_cast<int>(i);
+
+    for (BasicBlock* block : function->blocks) {
+        for (BasicBlock* succ : block->successors) {
+            if (std::find(succ->predecessors.begin(), succ->predecessors.end(), block) == succ->predecessors.end())
+                succ->predecessors.push_back(block);
+        }
+    }
+}
+
+// Builds the dominator tree and dominance frontiers with the iterative algorithm of
+// Cooper, Harvey and Kennedy. Expects computePredecessors to have run.
+void IR::computeDominators(Function* function) {
+    std::vector<BasicBlock*> &order = function->blocks;
+    for (BasicBlock* block : order) {
+        block->idom = nullptr;
+        block->domChildren.clear();
+        block->frontier.clear();
+    }
+    BasicBlock* entry = function->entry();
+    entry->idom = entry;
+
+    auto intersect = [](BasicBlock* a, BasicBlock* b) {
+        while (a != b) {
+            while (a->rpoIndex > b->rpoIndex) a = a->idom;
+            while (b->rpoIndex > a->rpoIndex) b = b->idom;
+        }
+        return a;
+    };
+
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 1; i < order.size(); i++) {
+            BasicBlock* block = order[i];
+            BasicBlock* newIdom = nullptr;
+            for (BasicBlock* pred : block->predecessors) {
+                if (!pred->idom) continue;
+                newIdom = newIdom ? intersect(pred, newIdom) : pred;
+            }
+            if (newIdom != block->idom) {
+                block->idom = newIdom;
+                changed = true;
+            }
+        }
+    }
+
+    for (size_t i = 1; i < order.size(); i++)
+        order[i]->idom->domChildren.push_back(order[i]);
+
+    for (BasicBlock* block : order) {
+        if (block->predecessors.size() < 2) continue;
+        for (BasicBlock* pred : block->predecessors) {
+            for (BasicBlock* runner = pred; runner != block->idom; runner = runner->idom) {
+                if (std::find(runner->frontier.begin(), runner->frontier.end(), block) == runner->frontier.end())
+                    runner->frontier.push_back(block);
+                if (runner == entry) break;
+            }
+        }
+    }
+
+    // Number the dominator tree so dominates() is a constant-time interval test.
+    int counter = 0;
+    std::vector<std::pair<BasicBlock*, size_t>> stack;
+    entry->domPre = counter++;
+    stack.push_back({entry, 0});
+    while (!stack.empty()) {
+        BasicBlock* block = stack.back().first;
+        size_t &next = stack.back().second;
+        if (next < block->domChildren.size()) {
+            BasicBlock* child = block->domChildren[next++];
+            child->domPre = counter++;
+            stack.push_back({child, 0});
+            continue;
+        }
+        block->domPost = counter++;
+        stack.pop_back();
+    }
+}
+
+bool IR::dominates(const BasicBlock* a, const BasicBlock* b) {
+    return a->domPre <= b->domPre && b->domPost <= a->domPost;
+}
+
+// Rewrites every method into SSA form. Locals and parameters get a numbered version
+// ("x.2") per assignment and phi nodes where definitions meet; the unnumbered name
+// stands for the value on entry. Temps are already assigned once, and fields are
+// left alone because they live in the object rather than the frame.
+void IR::buildSSA() {
+    if (errorOccurred) return;
+    for (Function* function : functions) {
+        if (function->inSSA) continue;
+        computePredecessors(function);
+        computeDominators(function);
+
+        // Place phi nodes on the iterated dominance frontier of each variable's definitions.
+        std::map<std::string, std::vector<BasicBlock*>> definedIn;
+        for (BasicBlock* block : function->blocks)
+            for (const Instruction &inst : block->instructions)
+                if (!inst.dst.empty() && function->locals.count(inst.dst))
+                    definedIn[inst.dst].push_back(block);
+
+        for (auto &var : definedIn) {
+            std::set<BasicBlock*> hasPhi;
+            std::vector<BasicBlock*> work = var.second;
+            while (!work.empty()) {
+                BasicBlock* block = work.back();
+                work.pop_back();
+                for (BasicBlock* join : block->frontier) {
+                    if (!hasPhi.insert(join).second) continue;
+                    Instruction phi(Instruction::Phi, var.first, var.first,
+                                    std::vector<std::string>(join->predecessors.size(), var.first));
+                    phi.sources = join->predecessors;
+                    join->instructions.insert(join->instructions.begin(), phi);
+                    work.push_back(join);
+                }
+            }
+        }
+
+        // Rename along the dominator tree, keeping a stack of live versions per variable.
+        std::unordered_map<std::string, std::vector<std::string>> versions;
+        std::unordered_map<std::string, int> counters;
+        auto current = [&](const std::string &name) -> const std::string& {
+            auto it = versions.find(name);
+            return it == versions.end() || it->second.empty() ? name : it->second.back();
+        };
+
+        struct RenameFrame { BasicBlock* block; size_t nextChild; std::vector<std::string> defined; };
+        std::vector<RenameFrame> stack;
+        stack.push_back({function->entry(), 0, {}});
+        bool entering = true;
+        while (!stack.empty()) {
+            RenameFrame &frame = stack.back();
+            BasicBlock* block = frame.block;
+            if (entering) {
+                for (Instruction &inst : block->instructions) {
+                    if (inst.kind != Instruction::Phi)
+                        for (std::string &arg : inst.args)
+                            if (function->locals.count(arg)) arg = current(arg);
+                    if (!inst.dst.empty() && function->locals.count(inst.dst)) {
+                        std::string base = inst.kind == Instruction::Phi ? inst.op : inst.dst;
+                        std::string version = base + "." + std::to_string(++counters[base]);
+                        versions[base].push_back(version);
+                        frame.defined.push_back(base);
+                        inst.dst = version;
+                    }
+                }
+                for (BasicBlock* succ : block->successors) {
+                    for (Instruction &inst : succ->instructions) {
+                        if (inst.kind != Instruction::Phi) break;
+                        for (size_t i = 0; i < inst.sources.size(); i++)
+                            if (inst.sources[i] == block) inst.args[i] = current(inst.op);
+                    }
+                }
+            }
+            if (frame.nextChild < block->domChildren.size()) {
+                BasicBlock* child = block->domChildren[frame.nextChild++];
+                stack.push_back({child, 0, {}});
+                entering = true;
+                continue;
+            }
+            for (const std::string &base : frame.defined)
+                versions[base].pop_back();
+            stack.pop_back();
+            entering = false;
+        }
+
+        // Minimal SSA places phis for variables that are dead at the join; drop them.
+        removeDeadValues(function, true);
+        function->inSSA = true;
+    }
+}
+
+// Removes computations whose value is never read, or with phisOnly just such phis.
+// Chains of dead values are followed with a worklist, so each goes in one pass.
+// Returns the number of instructions removed.
+int IR::removeDeadValues(Function* function, bool phisOnly) {
+    auto removable = [&](const Instruction &inst) {
+        bool pure = inst.kind == Instruction::Phi ||
+                    (!phisOnly && (inst.kind == Instruction::Const || inst.kind == Instruction::Copy ||
+                                   inst.kind == Instruction::Unary || inst.kind == Instruction::Binary));
+        return pure && !inst.dst.empty() && !function->isField(inst.dst);
+    };
+    std::unordered_map<std::string, int> uses;
+    std::unordered_map<std::string, std::pair<BasicBlock*, size_t>> definition;
+    for (BasicBlock* block : function->blocks) {
+        for (size_t i = 0; i < block->instructions.size(); i++) {
+            const Instruction &inst = block->instructions[i];
+            for (const std::string &arg : inst.args)
+                if (inst.kind != Instruction::Phi || arg != inst.dst) uses[arg]++;
+            if (removable(inst)) definition[inst.dst] = {block, i};
+        }
+    }
+
+    std::vector<std::string> work;
+    for (const auto &def : definition)
+        if (!uses[def.first]) work.push_back(def.first);
+    std::set<std::string> dead;
+    std::set<BasicBlock*> touched;
+    while (!work.empty()) {
+        std::string name = work.back();
+        work.pop_back();
+        if (!dead.insert(name).second) continue;
+        const auto &def = definition[name];
+        touched.insert(def.first);
+        for (const std::string &arg : def.first->instructions[def.second].args)
+            if (arg != name && --uses[arg] == 0 && definition.count(arg)) work.push_back(arg);
+    }
+
+    size_t removed = 0;
+    for (BasicBlock* block : touched)
+        removed += block->removeInstructions([&](const Instruction &inst) {
+            return removable(inst) && dead.count(inst.dst);
+        });
+    return static_cast<int>(removed);
+}
+
+// The variable an SSA name is a version of: "x" for "x.3".
+static std::string ssaBase(const std::string &name) {
+    return name.substr(0, name.find('.'));
+}
+
+// Live variables at block boundaries, by backward dataflow to a fixed point. A phi's
+// arguments are live out of the predecessor they come from, not live into its block.
+void IR::computeLiveness(Function* function) {
+    for (BasicBlock* block : function->blocks) {
+        block->liveIn.clear();
+        block->liveOut.clear();
+    }
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (auto it = function->blocks.rbegin(); it != function->blocks.rend(); ++it) {
+            BasicBlock* block = *it;
+            std::set<std::string> live;
+            for (BasicBlock* succ : block->successors) {
+                live.insert(succ->liveIn.begin(), succ->liveIn.end());
+                for (const Instruction &inst : succ->instructions) {
+                    if (inst.kind != Instruction::Phi) break;
+                    for (size_t i = 0; i < inst.sources.size(); i++)
+                        if (inst.sources[i] == block) live.insert(inst.args[i]);
+                }
+            }
+            block->liveOut = live;
+            for (auto inst = block->instructions.rbegin(); inst != block->instructions.rend(); ++inst) {
+                if (!inst->dst.empty()) live.erase(inst->dst);
+                if (inst->kind != Instruction::Phi) live.insert(inst->args.begin(), inst->args.end());
+            }
+            if (live != block->liveIn) {
+                block->liveIn.swap(live);
+                changed = true;
+            }
+        }
+    }
+}
+
+// Leaves SSA form. Where the versions of a variable never overlap, which is the usual
+// case, they are renamed back to the variable and its phis simply disappear. Otherwise
+// each phi gets a fresh temp that its predecessors assign just before their terminator
+// and that the phi's block copies into the phi's variable, so no edge needs splitting
+// and phis in one block cannot clobber each other's operands.
+void IR::leaveSSA() {
+    for (Function* function : functions) {
+        if (!function->inSSA) continue;
+        computeLiveness(function);
+
+        // Variables whose versions interfere, or that meet other values in a phi.
+        std::set<std::string> split;
+        auto checkInterference = [&](const std::set<std::string> &live, const std::string &name) {
+            std::string base = ssaBase(name);
+            if (split.count(base)) return;
+            if (base != name && live.count(base)) { split.insert(base); return; }
+            for (auto it = live.lower_bound(base + "."); it != live.end() && it->compare(0, base.size() + 1, base + ".") == 0; ++it)
+                if (*it != name) { split.insert(base); return; }
+        };
+        for (BasicBlock* block : function->blocks) {
+            std::set<std::string> live = block->liveOut;
+            for (auto inst = block->instructions.rbegin(); inst != block->instructions.rend(); ++inst) {
+                if (inst->kind == Instruction::Phi) {
+                    checkInterference(block->liveIn, inst->dst);
+                    for (const std::string &arg : inst->args)
+                        if (ssaBase(arg) != ssaBase(inst->dst)) split.insert(ssaBase(inst->dst));
+                    continue;
+                }
+                if (!inst->dst.empty()) {
+                    live.erase(inst->dst);
+                    checkInterference(live, inst->dst);
+                }
+                live.insert(inst->args.begin(), inst->args.end());
+            }
+        }
+
+        for (BasicBlock* block : function->blocks) {
+            auto &insts = block->instructions;
+            for (size_t i = 0; i < insts.size() && insts[i].kind == Instruction::Phi; i++) {
+                Instruction &phi = insts[i];
+                if (!split.count(ssaBase(phi.dst))) continue;
+                std::string temp = newTemp();
+                for (size_t p = 0; p < phi.sources.size(); p++) {
+                    auto &predInsts = phi.sources[p]->instructions;
+                    auto pos = predInsts.end();
+                    if (!predInsts.empty() && predInsts.back().isTerminator()) --pos;
+                    predInsts.insert(pos, Instruction(Instruction::Copy, temp, "", {phi.args[p]}, nullptr, "phi " + phi.op));
+                }
+                phi = Instruction(Instruction::Copy, phi.dst, "", {temp}, nullptr, "phi " + phi.op);
+            }
+            insts.erase(std::remove_if(insts.begin(), insts.end(), [](const Instruction &inst) {
+                return inst.kind == Instruction::Phi;
+            }), insts.end());
+        }
+
+        auto rename = [&](std::string &name) {
+            if (name.find('.') != std::string::npos && !split.count(ssaBase(name))) name = ssaBase(name);
+        };
+        for (BasicBlock* block : function->blocks) {
+            for (Instruction &inst : block->instructions) {
+                rename(inst.dst);
+                for (std::string &arg : inst.args) rename(arg);
+            }
+        }
+        function->inSSA = false;
+    }
+}
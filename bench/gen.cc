@@ -0,0 +1,136 @@
+// Synthetic miniJava generator for benchmarks and scaling tests.
+// Usage: gen [--statements N] [--classes C] [--methods M] [--depth D] [--nesting B] [N]
+//   --statements  total statements spread over all method bodies (a bare N means the same)
+//   --classes     number of classes; by default derived from the statement count
+//   --methods     methods per class (default 8)
+//   --depth       adds a method whose expressions are D operators deep, both as a
+//                 left-leaning "a + 1 + 1 ..." chain and as right-nested parentheses
+//   --nesting     adds a method with if statements nested B levels deep
+// The program is written to stdout and follows the grammar in parser.yy.
+#include <iostream>
+#include <string>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+const int STATEMENTS_PER_METHOD = 40;
+
+struct Knobs {
+    long statements = 0;
+    long classes = 0;
+    long methodsPerClass = 8;
+    long depth = 0;
+    long nesting = 0;
+};
+
+// One statement of a method body; cycles through assignments, if/else and short loops.
+void emitStatement(long n)
+{
+    switch (n % 5) {
+    case 0: cout << "        a = (a + " << n % 97 << ") * 3;\n"; break;
+    case 1: cout << "        b = (b - a) + (c * " << n % 13 << ");\n"; break;
+    case 2:
+        cout << "        if ((a < b) && (0 < c)) {\n"
+             << "            c = c + 1;\n"
+             << "        } else {\n"
+             << "            c = c - 1;\n"
+             << "        }\n";
+        break;
+    case 3:
+        cout << "        i = 0;\n"
+             << "        while (i < " << n % 7 + 1 << ") {\n"
+             << "            a = a + i;\n"
+             << "            i = i + 1;\n"
+             << "        }\n";
+        break;
+    default: cout << "        c = (a + b) - (c * 2);\n"; break;
+    }
+}
+
+void emitMethodHeader(const string &name)
+{
+    cout << "    public int " << name << "(int a) {\n"
+         << "        int b;\n        int c;\n        int i;\n"
+         << "        b = a;\n        c = 1;\n";
+}
+
+// Expressions "depth" operators deep, in both associativity shapes.
+void emitDeepExpressions(long depth)
+{
+    emitMethodHeader("deep");
+    cout << "        b = a";
+    for (long d = 0; d < depth; d++)
+        cout << (d % 16 == 15 ? " +\n            1" : " + 1");
+    cout << ";\n        c = ";
+    for (long d = 0; d < depth; d++)
+        cout << "(1 + ";
+    cout << "a";
+    for (long d = 0; d < depth; d++)
+        cout << ')';
+    cout << ";\n        return b + c;\n    }\n";
+}
+
+// If statements nested "nesting" levels deep.
+void emitNestedIfs(long nesting)
+{
+    emitMethodHeader("nested");
+    for (long d = 0; d < nesting; d++)
+        cout << "        if (b < " << d + 1000000 << ") {\n";
+    cout << "        b = b + 1;\n";
+    for (long d = 0; d < nesting; d++)
+        cout << "        } else {\n        c = c + 1;\n        }\n";
+    cout << "        return b;\n    }\n";
+}
+
+int main(int argc, char **argv)
+{
+    Knobs knobs;
+    for (int i = 1; i < argc; i++) {
+        bool hasValue = i + 1 < argc;
+        if (!strcmp(argv[i], "--statements") && hasValue) knobs.statements = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--classes") && hasValue) knobs.classes = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--methods") && hasValue) knobs.methodsPerClass = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--depth") && hasValue) knobs.depth = atol(argv[++i]);
+        else if (!strcmp(argv[i], "--nesting") && hasValue) knobs.nesting = atol(argv[++i]);
+        else if (argv[i][0] != '-') knobs.statements = atol(argv[i]);
+        else {
+            cerr << "Usage: " << argv[0] << " [--statements N] [--classes C] [--methods M] [--depth D] [--nesting B] [N]\n";
+            return 1;
+        }
+    }
+    if (knobs.methodsPerClass < 1) knobs.methodsPerClass = 1;
+
+    long methods = knobs.statements / STATEMENTS_PER_METHOD + 1;
+    long classes = knobs.classes > 0 ? knobs.classes
+                                     : (methods + knobs.methodsPerClass - 1) / knobs.methodsPerClass;
+    long methodsPerClass = knobs.classes > 0 ? (methods + classes - 1) / classes : knobs.methodsPerClass;
+    if (methodsPerClass < 1) methodsPerClass = 1;
+
+    cout << "public class Synthetic {\n"
+         << "    public static void main(String[] args) {\n";
+    for (long c = 0; c < classes; c++)
+        cout << "        System.out.println(new C" << c << "().m0(" << c % 10 << "));\n";
+    if (knobs.depth > 0)
+        cout << "        System.out.println(new C0().deep(1));\n";
+    if (knobs.nesting > 0)
+        cout << "        System.out.println(new C0().nested(1));\n";
+    cout << "    }\n}\n";
+
+    long emitted = 0;
+    for (long c = 0; c < classes; c++) {
+        cout << "\nclass C" << c << " {\n";
+        for (long m = 0; m < methodsPerClass; m++) {
+            emitMethodHeader("m" + to_string(m));
+            for (int s = 0; s < STATEMENTS_PER_METHOD && emitted < knobs.statements; s++)
+                emitStatement(emitted++);
+            cout << "        return (a + b) + c;\n    }\n";
+        }
+        if (c == 0 && knobs.depth > 0)
+            emitDeepExpressions(knobs.depth);
+        if (c == 0 && knobs.nesting > 0)
+            emitNestedIfs(knobs.nesting);
+        cout << "}\n";
+    }
+    return 0;
+}
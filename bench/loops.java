@@ -0,0 +1,25 @@
+// Tight counting loops: the common shape of our hottest programs.
+public class Loops {
+    public static void main(String[] a) {
+        System.out.println(new Counter().run(300));
+    }
+}
+
+class Counter {
+    public int run(int n) {
+        int i;
+        int j;
+        int sum;
+        sum = 0;
+        i = 0;
+        while (i < n) {
+            j = 0;
+            while (j < n) {
+                sum = sum + (i * j);
+                j = j + 1;
+            }
+            i = i + 1;
+        }
+        return sum;
+    }
+}
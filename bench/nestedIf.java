@@ -0,0 +1,46 @@
+// Branch-heavy code: nested if/else chains inside a loop.
+public class NestedIf {
+    public static void main(String[] a) {
+        System.out.println(new Classifier().run(20000));
+    }
+}
+
+class Classifier {
+    public int run(int n) {
+        int i;
+        int small;
+        int medium;
+        int large;
+        int r;
+        small = 0;
+        medium = 0;
+        large = 0;
+        i = 0;
+        while (i < n) {
+            r = (i * 7) - ((i * 7) - 13);
+            if (i < 100) {
+                if (r < 5) {
+                    small = small + 1;
+                } else {
+                    small = small + 2;
+                }
+            } else {
+                if (i < 1000) {
+                    if ((r == 13) && (0 < i)) {
+                        medium = medium + 1;
+                    } else {
+                        medium = medium - 1;
+                    }
+                } else {
+                    if (!(i < 5000)) {
+                        large = large + 1;
+                    } else {
+                        large = large + 3;
+                    }
+                }
+            }
+            i = i + 1;
+        }
+        return (small + medium) + large;
+    }
+}
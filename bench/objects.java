@@ -0,0 +1,51 @@
+// Object-heavy code: many small objects and getter/setter style calls. The checksum stays
+// well within int range.
+public class Objects {
+    public static void main(String[] a) {
+        System.out.println(new Driver().run(5000));
+    }
+}
+
+class Point {
+    int x;
+    int y;
+
+    public int set(int nx, int ny) {
+        x = nx;
+        y = ny;
+        return 0;
+    }
+
+    public int getX() {
+        return x;
+    }
+
+    public int getY() {
+        return y;
+    }
+
+    public int dot(Point other) {
+        return (x * (other.getX())) + (y * (other.getY()));
+    }
+}
+
+class Driver {
+    public int run(int n) {
+        int i;
+        int total;
+        int ignored;
+        Point p;
+        Point q;
+        total = 0;
+        i = 0;
+        while (i < n) {
+            p = new Point();
+            q = new Point();
+            ignored = p.set(i, i + 1);
+            ignored = q.set(2, 3);
+            total = total + (p.dot(q));
+            i = i + 1;
+        }
+        return total;
+    }
+}
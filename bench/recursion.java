@@ -0,0 +1,29 @@
+// Recursive calls: naive Fibonacci and an accumulator-style sum.
+public class Recursion {
+    public static void main(String[] a) {
+        System.out.println(new Fib().fib(22));
+        System.out.println(new Fib().sum(5000, 0));
+    }
+}
+
+class Fib {
+    public int fib(int n) {
+        int r;
+        if (n < 2) {
+            r = n;
+        } else {
+            r = (this.fib(n - 1)) + (this.fib(n - 2));
+        }
+        return r;
+    }
+
+    public int sum(int n, int acc) {
+        int r;
+        if (n < 1) {
+            r = acc;
+        } else {
+            r = this.sum(n - 1, acc + n);
+        }
+        return r;
+    }
+}
@@ -0,0 +1,67 @@
+#!/bin/sh
+# Benchmark harness: compiles every program in bench/ plus generated sources,
+# runs the bytecode and appends one CSV row per program to the results file.
+# Usage: bench/run.sh [results.csv]   (run "make bench" to build optimised binaries first)
+
+BENCH_DIR=$(cd "$(dirname "$0")" && pwd)
+RESULTS=${1:-$BENCH_DIR/results.csv}
+COMPILER=$BENCH_DIR/compiler
+INTERPRETER=$BENCH_DIR/interpreter
+GEN=$BENCH_DIR/gen
+SYNTHETIC_SIZES=${SYNTHETIC_SIZES:-"10000 100000"}
+COMPILER_FLAGS=${COMPILER_FLAGS:-}   # e.g. COMPILER_FLAGS=-O to benchmark optimised bytecode
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+COMMIT=$(git -C "$BENCH_DIR" rev-parse --short HEAD 2>/dev/null || echo unknown)
+if [ ! -f "$RESULTS" ]; then
+    echo "commit,program,lines,compile_s,lines_per_s,vm_instructions,vm_s,instructions_per_s,status" > "$RESULTS"
+fi
+
+now() { date +%s.%N; }
+
+bench_one() {
+    name=$1
+    source=$2
+    lines=$(wc -l < "$source")
+
+    start=$(now)
+    (cd "$WORK" && "$COMPILER" $COMPILER_FLAGS "$source" > compile.log 2>&1)
+    compileStatus=$?
+    end=$(now)
+    compileTime=$(echo "$start $end" | awk '{ printf "%.6f", $2 - $1 }')
+    linesPerSec=$(echo "$lines $compileTime" | awk '{ if ($2 > 0) printf "%.0f", $1 / $2; else print 0 }')
+
+    status=ok
+    instructions=0
+    vmTime=0
+    if [ $compileStatus -ne 0 ]; then
+        status=compile-error
+    elif [ ! -f "$WORK/output.class" ] || grep -q "GENERATION FAILED" "$WORK/output.class"; then
+        status=ir-error
+    else
+        (cd "$WORK" && "$INTERPRETER" --stats output.class > run.log 2> stats.log)
+        [ $? -ne 0 ] && status=vm-error
+        instructions=$(sed -n 's/.*instructions=\([0-9]*\).*/\1/p' "$WORK/stats.log")
+        vmTime=$(sed -n 's/.*wall_s=\([0-9.e+-]*\).*/\1/p' "$WORK/stats.log")
+        instructions=${instructions:-0}
+        vmTime=${vmTime:-0}
+    fi
+    instrPerSec=$(echo "$instructions $vmTime" | awk '{ if ($2 > 0) printf "%.0f", $1 / $2; else print 0 }')
+
+    echo "$COMMIT,$name,$lines,$compileTime,$linesPerSec,$instructions,$vmTime,$instrPerSec,$status" >> "$RESULTS"
+    printf "%-24s %8s lines %10s lines/s %12s instr/s  %s\n" "$name" "$lines" "$linesPerSec" "$instrPerSec" "$status"
+    rm -f "$WORK/output.class"
+}
+
+for program in "$BENCH_DIR"/*.java; do
+    bench_one "$(basename "$program" .java)" "$program"
+done
+
+for size in $SYNTHETIC_SIZES; do
+    "$GEN" --statements "$size" > "$WORK/synthetic_$size.java"
+    bench_one "synthetic_$size" "$WORK/synthetic_$size.java"
+done
+
+echo "Results appended to $RESULTS"
@@ -0,0 +1,80 @@
+#!/bin/sh
+# Scaling report: sweeps the generator knobs over doubling sizes, records the
+# per-phase compile times from "compiler --phase-times" and shows how each phase
+# grows. A growth exponent near 1 is linear, near 2 quadratic. Crashes (e.g. a
+# stack overflow in a recursive pass, exit code 139) are reported with the first
+# size that triggered them.
+# Usage: bench/scaling.sh [scaling.csv]   (run "make bench gen" first)
+
+BENCH_DIR=$(cd "$(dirname "$0")" && pwd)
+RESULTS=${1:-$BENCH_DIR/scaling.csv}
+COMPILER=$BENCH_DIR/compiler
+GEN=$BENCH_DIR/gen
+TIMEOUT=${TIMEOUT:-300}
+STATEMENTS=${STATEMENTS:-"1000 2000 4000 8000 16000 32000 64000 128000"}
+DEPTHS=${DEPTHS:-"500 1000 2000 4000 8000 16000 32000 64000"}
+NESTINGS=${NESTINGS:-"250 500 1000 2000 4000 8000 16000"}
+CLASSES=${CLASSES:-"250 500 1000 2000 4000 8000"}
+PHASES="parse symbols semantic ir bytecode"
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+echo "knob,value,lines,status,exit_code,parse_s,symbols_s,semantic_s,ir_s,bytecode_s" > "$RESULTS"
+
+run_point() {
+    knob=$1
+    value=$2
+    "$GEN" "--$knob" "$value" > "$WORK/input.java"
+    lines=$(wc -l < "$WORK/input.java")
+    (cd "$WORK" && timeout "$TIMEOUT" "$COMPILER" --phase-times input.java > /dev/null 2> phases.log)
+    code=$?
+    case $code in
+        0) status=ok ;;
+        124) status=timeout ;;
+        134|139) status=crash ;;
+        *) status=error ;;
+    esac
+    row="$knob,$value,$lines,$status,$code"
+    for phase in $PHASES; do
+        t=$(sed -n "s/.* ${phase}_s=\([0-9.e+-]*\).*/\1/p" "$WORK/phases.log")
+        row="$row,${t:-}"
+    done
+    echo "$row" >> "$RESULTS"
+    echo "$row"
+}
+
+for v in $STATEMENTS; do run_point statements "$v"; done
+for v in $DEPTHS; do run_point depth "$v"; done
+for v in $NESTINGS; do run_point nesting "$v"; done
+for v in $CLASSES; do run_point classes "$v"; done
+
+# Growth exponent of each phase between consecutive sizes of the same knob:
+# log(t2 / t1) / log(n2 / n1), using generated lines as the size.
+echo
+echo "Growth exponents (1 = linear, 2 = quadratic; '!' marks > 1.5):"
+awk -F, -v phases="$PHASES" '
+    NR == 1 { next }
+    {
+        if ($1 != knob) { knob = $1; prevLines = 0; crashed = 0 }
+        if ($4 != "ok") {
+            if (!crashed) printf "  %-10s first %s at %s=%s (exit code %s)\n", knob, $4, knob, $2, $5
+            crashed = 1
+            next
+        }
+        if (prevLines > 0 && $3 > prevLines) {
+            line = sprintf("  %-10s %8s -> %-8s", knob, prevValue, $2)
+            for (i = 6; i <= 10; i++) {
+                if (prev[i] > 0 && $i > 0) {
+                    e = log($i / prev[i]) / log($3 / prevLines)
+                    line = line sprintf(" %s=%.2f%s", names[i - 5], e, (e > 1.5 ? "!" : ""))
+                }
+            }
+            print line
+        }
+        prevLines = $3; prevValue = $2
+        for (i = 6; i <= 10; i++) prev[i] = $i
+    }
+    BEGIN { split(phases, names, " ") }
+' "$RESULTS"
+echo "Raw results in $RESULTS"
@@ -0,0 +1,124 @@
+// Inlining: calls to small methods, resolved by semantic analysis, are replaced by a
+// renamed copy of the callee's CFG, so hot loops stop paying for a frame per call.
+
+// Counts the instructions of a function, leaving out comments.
+static size_t functionSize(const Function* function) {
+    size_t size = 0;
+    for (const BasicBlock* block : function->blocks)
+        for (const Instruction &inst : block->instructions)
+            if (inst.kind != Instruction::Comment) size++;
+    return size;
+}
+
+// The fields of 'this' that a function reads or writes.
+static std::set<std::string> fieldsUsed(const Function* function) {
+    std::set<std::string> fields;
+    for (const BasicBlock* block : function->blocks)
+        for (const Instruction &inst : block->instructions) {
+            if (!inst.dst.empty() && function->isField(inst.dst)) fields.insert(inst.dst);
+            for (const std::string &arg : inst.args)
+                if (function->isField(arg)) fields.insert(arg);
+        }
+    return fields;
+}
+
+// Whether the caller has a local or parameter named like one of the callee's fields. The
+// inlined code names fields as the callee did, so they would resolve to that variable.
+static bool shadowsField(const Function* caller, const std::set<std::string> &fields) {
+    for (const std::string &field : fields)
+        if (caller->locals.count(field)) return true;
+    return false;
+}
+
+// Replaces the call at 'index' in 'block' by a copy of the callee and returns the block
+// holding the instructions that followed the call. The callee's variables and temps get
+// fresh names; 'this' and the parameters start as copies of the call's operands, locals
+// read before being assigned start at 0, and each return becomes a copy into the call's
+// result and a jump to the code after the call.
+BasicBlock* IR::inlineCall(Function* caller, BasicBlock* block, size_t index, Function* callee) {
+    const Instruction call = block->instructions[index];
+    BasicBlock* rest = createBlock(caller);
+    rest->instructions.assign(block->instructions.begin() + index + 1, block->instructions.end());
+    rest->successors.swap(block->successors);
+    block->instructions.erase(block->instructions.begin() + index, block->instructions.end());
+
+    std::map<std::string, std::string> renamed;
+    auto rename = [&](const std::string &name) {
+        if (callee->isField(name) || (name == "this" && call.args[0] == "this")) return name;
+        auto found = renamed.find(name);
+        if (found != renamed.end()) return found->second;
+        std::string fresh = newTemp();
+        // Variables may be assigned more than once; temps keep a single assignment.
+        if (callee->locals.count(name)) caller->locals.insert(fresh);
+        renamed[name] = fresh;
+        return fresh;
+    };
+
+    if (call.args[0] != "this")
+        block->addInstruction(Instruction(Instruction::Copy, rename("this"), "", {call.args[0]}, nullptr, "inline this"));
+    for (size_t i = 0; i < callee->params.size() && i + 1 < call.args.size(); i++)
+        block->addInstruction(Instruction(Instruction::Copy, rename(callee->params[i]), "", {call.args[i + 1]}, nullptr, "inline " + callee->params[i]));
+    computeLiveness(callee);
+    for (const std::string &name : callee->entry()->liveIn)
+        if (callee->locals.count(name) && std::find(callee->params.begin(), callee->params.end(), name) == callee->params.end())
+            block->addInstruction(Instruction(Instruction::Const, rename(name), "0", {}, nullptr, "inline " + name));
+
+    std::map<BasicBlock*, BasicBlock*> clones;
+    for (BasicBlock* original : callee->blocks) clones[original] = createBlock(caller);
+    for (BasicBlock* original : callee->blocks) {
+        BasicBlock* copy = clones[original];
+        for (const Instruction &inst : original->instructions) {
+            if (inst.kind == Instruction::Comment) continue;
+            if (inst.kind == Instruction::Return) {
+                copy->addInstruction(Instruction(Instruction::Copy, call.dst, "", {rename(inst.args[0])}, nullptr, "inline return"));
+                copy->addInstruction(Instruction(Instruction::Goto, "", "", {}, rest));
+                copy->addSuccessor(rest);
+                break;
+            }
+            Instruction renamedInst = inst;
+            if (!inst.dst.empty()) renamedInst.dst = rename(inst.dst);
+            for (std::string &arg : renamedInst.args) arg = rename(arg);
+            if (inst.target) renamedInst.target = clones[inst.target];
+            copy->addInstruction(renamedInst);
+        }
+        if (copy->successors.empty())
+            for (BasicBlock* succ : original->successors) copy->addSuccessor(clones[succ]);
+    }
+
+    BasicBlock* start = clones[callee->entry()];
+    block->addInstruction(Instruction(Instruction::Goto, "", "", {}, start, "inline " + callee->name));
+    block->addSuccessor(start);
+    return rest;
+}
+
+// Inlines every call to a method of at most 'budget' instructions in the functions not
+// yet in SSA form, and returns the number of calls inlined. Calls are only inlined from
+// the caller's own code, not from bodies inlined into it, so recursion cannot unroll.
+// A method that uses fields is only inlined for calls on 'this', since fields of another
+// object cannot be named in the caller, and only into callers with no variable of the same
+// name as one of those fields.
+int IR::inlineCalls(size_t budget) {
+    int total = 0;
+    for (Function* caller : functions) {
+        if (caller->inSSA) continue;
+        std::vector<BasicBlock*> work(caller->blocks.rbegin(), caller->blocks.rend());
+        while (!work.empty()) {
+            BasicBlock* block = work.back();
+            work.pop_back();
+            for (size_t i = 0; i < block->instructions.size(); i++) {
+                const Instruction &inst = block->instructions[i];
+                if (inst.kind != Instruction::Call) continue;
+                if (inst.method < 0 || inst.method >= (int)functions.size()) continue;
+                Function* callee = functions[inst.method];
+                if (callee == caller || callee->inSSA || functionSize(callee) > budget) continue;
+                std::set<std::string> fields = fieldsUsed(callee);
+                if (!fields.empty() && (inst.args[0] != "this" || shadowsField(caller, fields))) continue;
+                work.push_back(inlineCall(caller, block, i, callee));
+                caller->optCounts["inlined"]++;
+                total++;
+                break;
+            }
+        }
+    }
+    return total;
+}
@@ -1,139 +1,190 @@
 #include <iostream>
 #include <fstream>
 #include <sstream>
-#include <stack>
-#include <unordered_map>
-#include <vector>
 #include <string>
+#include <vector>
+#include <atomic>
+#include <thread>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
 
-using namespace std;
-
-vector<string> instructions;
-
-void executeInstruction()
-{
-    std::stack<int> data;                       // data stack
-    std::unordered_map<std::string,int> locals; // temps: _t1 = x
-
-    for (const auto& raw : instructions)
-    {
-        if (raw.empty()) continue;
+#include "mjvm.h"
 
-        std::string line = raw.substr(raw.find_first_not_of(" \t"));
-        if (line.rfind("label", 0) == 0) continue;
+// Writes 'text' as a JSON string.
+static void writeJsonString(std::ostream& out, const std::string& text) {
+    out << '"';
+    for (unsigned char c : text) {
+        if (c == '"' || c == '\\') out << '\\' << c;
+        else if (c == '\n') out << "\\n";
+        else if (c < 0x20) {
+            static const char hex[] = "0123456789abcdef";
+            out << "\\u00" << hex[c >> 4] << hex[c & 15];
+        }
+        else out << c;
+    }
+    out << '"';
+}
 
-        std::istringstream iss(line);
-        std::string op;
-        iss >> op;
+// One program of a batch and what became of it.
+struct BatchRun {
+    std::string file;
+    int status = 0;                 // the exit status running it alone would have had
+    bool rejected = false;          // it could not be loaded or failed verification
+    mjvm::Result result;
+    std::string output;             // what it printed
+    double loadSeconds = 0;
+};
 
-        if (op == "iconst")
-        {
-            int v;
-            iss >> v;
-            data.push(v);
-        }
-        else if (op == "iload")
-        {
-            std::string v;
-            iss >> v;
-            data.push(locals[v]);
-        }
-        else if (op == "istore")
-        {
-            std::string v;
-            iss >> v;
-            int val = data.top();
-            data.pop();
-            locals[v] = val;
-        }
-        else if (op == "iadd")
-        {
-            int b = data.top(); data.pop();
-            int a = data.top(); data.pop();
-            data.push(a + b);
-        }
-        else if (op == "isub")
-        {
-            int b = data.top(); data.pop();
-            int a = data.top(); data.pop();
-            data.push(a - b);
-        }
-        else if (op == "imul")
-        {
-            int b = data.top(); data.pop();
-            int a = data.top(); data.pop();
-            data.push(a * b);
-        }
-        else if (op == "idiv")
-        {
-            int b = data.top(); data.pop();
-            int a = data.top(); data.pop();
-            data.push(a / b);
-        }
-        else if (op == "iand")
-        {
-            int b = data.top(); data.pop();
-            int a = data.top(); data.pop();
-            data.push((a && b) ? 1 : 0);
-        }
-        else if (op == "ior")
-        {
-            int b = data.top(); data.pop();
-            int a = data.top(); data.pop();
-            data.push((a || b) ? 1 : 0);
-        }
-        else if (op == "inot")
-        {
-            int a = data.top(); data.pop();
-            data.push(!a);
-        }
-        else if (op == "ieq")
-        {
-            int b = data.top(); data.pop();
-            int a = data.top(); data.pop();
-            data.push((a == b) ? 1 : 0);
-        }
-        else if (op == "igt")
-        {
-            int b = data.top(); data.pop();
-            int a = data.top(); data.pop();
-            data.push((a > b) ? 1 : 0);
-        }
-        else if (op == "ilt")
-        {
-            int b = data.top(); data.pop();
-            int a = data.top(); data.pop();
-            data.push((a < b) ? 1 : 0);
+// Runs every .class file listed in 'manifest', one per line, on 'jobs' threads and writes
+// one JSON object per program, in manifest order, to 'out'. Each thread has its own context
+// and takes the next program when it finishes one; programs share nothing, so throughput
+// grows with the number of cores.
+static int runBatch(const std::string& manifest, unsigned jobs, const mjvm::Limits& limits, std::ostream& out) {
+    std::ifstream list(manifest);
+    if (!list) {
+        std::cerr << "Error opening file: " << manifest << '\n';
+        return 1;
+    }
+    std::vector<BatchRun> runs;
+    std::string line;
+    while (std::getline(list, line))
+        if (!line.empty()) {
+            runs.emplace_back();
+            runs.back().file = line;
         }
-        else if (op == "print")
-        {
-            std::cout << data.top() << '\n';
-            data.pop();
+
+    auto begin = std::chrono::steady_clock::now();
+    std::atomic<size_t> next(0);
+    auto work = [&]() {
+        mjvm::Context context;
+        context.limits = limits;
+        for (size_t i = next++; i < runs.size(); i = next++) {
+            BatchRun& run = runs[i];
+            auto start = std::chrono::steady_clock::now();
+            std::shared_ptr<const mjvm::Module> module;
+            try {
+                module = mjvm::loadFile(run.file);
+            } catch (const std::exception& e) {
+                run.status = 1;
+                run.rejected = true;
+                run.result.error = e.what();
+                continue;
+            }
+            std::chrono::duration<double> load = std::chrono::steady_clock::now() - start;
+            run.loadSeconds = load.count();
+            std::ostringstream output;
+            mjvm::StreamSink sink(output);
+            run.result = context.run(*module, sink);
+            run.output = output.str();
+            run.status = run.result.status == mjvm::Result::Failed ? 1 : run.result.status == mjvm::Result::Terminated ? 3 : 0;
         }
-        else if (op == "stop")
-        {
-            break;
+    };
+    std::vector<std::thread> workers;
+    for (unsigned j = 1; j < jobs; j++)
+        workers.emplace_back(work);
+    work();
+    for (std::thread& worker : workers)
+        worker.join();
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - begin;
+
+    static const char* statusNames[] = {"finished", "failed", "terminated"};
+    for (const BatchRun& run : runs) {
+        out << "{\"file\":";
+        writeJsonString(out, run.file);
+        out << ",\"status\":\"" << (run.rejected ? "rejected" : statusNames[run.result.status]) << "\",\"exit\":" << run.status;
+        if (!run.result.error.empty()) {
+            out << ",\"error\":";
+            writeJsonString(out, run.result.error);
         }
+        out << ",\"instructions\":" << run.result.instructions << ",\"heap_bytes\":" << run.result.heapBytes
+            << ",\"load_s\":" << run.loadSeconds << ",\"run_s\":" << run.result.wallSeconds << ",\"output\":";
+        writeJsonString(out, run.output);
+        out << "}\n";
     }
+    std::cerr << "batch: programs=" << runs.size() << " jobs=" << jobs << " wall_s=" << wall.count()
+              << " programs_per_s=" << runs.size() / wall.count() << '\n';
+    return 0;
 }
 
+// Command-line front end of libmjvm: loads one .class file and runs it once, or runs a
+// batch of them.
 int main(int argc, char **argv) {
-    if (argc != 2 || std::string(argv[1]).substr(std::string(argv[1]).find_last_of('.')) != ".class") {
-        std::cerr << "Usage: " << argv[0] << " <filename.class>\n";
+    bool stats = false;
+    bool profiling = false;
+    mjvm::Context context;
+    std::string fileName, foldedName, manifest, resultsName;
+    unsigned jobs = std::max(1u, std::thread::hardware_concurrency());
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--stats") stats = true;
+        else if (arg == "--profile") profiling = true;
+        else if (arg.compare(0, 9, "--folded=") == 0) foldedName = arg.substr(9), profiling = true;
+        else if (arg.rfind("--max-instructions=", 0) == 0) context.limits.maxInstructions = std::strtoll(arg.c_str() + 19, nullptr, 10);
+        else if (arg.rfind("--timeout=", 0) == 0) context.limits.timeout = std::strtod(arg.c_str() + 10, nullptr);
+        else if (arg.rfind("--max-heap=", 0) == 0) context.limits.maxHeap = std::strtoull(arg.c_str() + 11, nullptr, 10);
+        else if (arg.rfind("--max-depth=", 0) == 0) context.limits.maxDepth = std::strtoull(arg.c_str() + 12, nullptr, 10);
+        else if (arg.rfind("--batch=", 0) == 0) manifest = arg.substr(8);
+        else if (arg.rfind("--jobs=", 0) == 0) jobs = std::max(1ul, std::strtoul(arg.c_str() + 7, nullptr, 10));
+        else if (arg.rfind("--results=", 0) == 0) resultsName = arg.substr(10);
+        else fileName = arg;
+    }
+    if (!manifest.empty()) {
+        if (resultsName.empty())
+            return runBatch(manifest, jobs, context.limits, std::cout);
+        std::ofstream results(resultsName);
+        if (!results) {
+            std::cerr << "Error opening file: " << resultsName << '\n';
+            return 1;
+        }
+        return runBatch(manifest, jobs, context.limits, results);
+    }
+    if (fileName.size() < 6 || fileName.substr(fileName.size() - 6) != ".class") {
+        std::cerr << "Usage: " << argv[0] << " [--stats] [--profile] [--folded=FILE]"
+                  << " [--max-instructions=N] [--timeout=SECONDS] [--max-heap=BYTES] [--max-depth=N] <filename.class>\n"
+                  << "       " << argv[0] << " --batch=MANIFEST [--jobs=N] [--results=FILE] [limits]\n";
         return 1;
     }
 
-    ifstream inputFile(argv[1]);
-    if (!inputFile) {
-        std::cerr << "Error opening file: " << argv[1] << '\n';
+    if (!std::ifstream(fileName)) {
+        std::cerr << "Error opening file: " << fileName << '\n';
+        return 1;
+    }
+    std::shared_ptr<const mjvm::Module> module;
+    try {
+        module = mjvm::loadFile(fileName);
+    } catch (const std::exception& e) {
+        std::cerr << "Verification failed: " << e.what() << '\n';
         return 1;
     }
 
-    string line;
-    while (getline(inputFile, line))
-        instructions.push_back(line);
-    inputFile.close();
+    mjvm::StreamSink out(std::cout);
+    mjvm::Profile profile(*module);
+    mjvm::Result result = context.run(*module, out, profiling ? &profile : nullptr);
+    int status = 0;
+    if (result.status == mjvm::Result::Failed) {
+        std::cerr << "Runtime error: " << result.error << '\n';
+        status = 1;
+    } else if (result.status == mjvm::Result::Terminated) {
+        // Killed runs always report how far they got.
+        std::cerr << "Terminated: " << result.error << '\n';
+        stats = true;
+        status = 3;
+    }
 
-    executeInstruction();
-    return 0;
+    // Machine-readable counters for bench/run.sh.
+    if (stats)
+        std::cerr << "stats: instructions=" << result.instructions << " wall_s=" << result.wallSeconds
+                  << " heap_bytes=" << result.heapBytes << '\n';
+    if (profiling)
+        mjvm::printProfile(*module, profile, std::cerr);
+    if (!foldedName.empty()) {
+        std::ofstream folded(foldedName);
+        if (!folded) {
+            std::cerr << "Error opening file: " << foldedName << '\n';
+            return 1;
+        }
+        mjvm::writeFolded(*module, profile, folded);
+    }
+    return status;
 }
@@ -0,0 +1,66 @@
+// Block layout for bytecode emission: blocks are chained along their fall-through
+// successors and loops whose test sits at the top are rotated so it sits at the bottom,
+// leaving one taken branch per iteration instead of a goto plus a branch.
+
+// Returns the order in which the reachable blocks of a function are emitted, entry first.
+std::vector<BasicBlock*> IR::layoutBlocks(Function* function) {
+    computePredecessors(function);
+    computeDominators(function);
+    std::vector<Loop> loops = findLoops(function);
+    std::map<BasicBlock*, const Loop*> innermost;
+    for (const Loop &loop : loops)
+        for (BasicBlock* block : loop.body) innermost.insert({block, &loop});
+    auto leavesLoop = [&](BasicBlock* from, BasicBlock* to) {
+        auto loop = innermost.find(from);
+        return loop != innermost.end() && !loop->second->body.count(to);
+    };
+
+    // Reverse postorder, so a join comes after both branches and a loop's exit after its
+    // body. The successor visited last is laid out right after its block, so that is the
+    // one the block should fall into: its first successor, unless that leaves the loop.
+    std::vector<BasicBlock*> postorder;
+    std::set<BasicBlock*> visited;
+    struct LayoutFrame { BasicBlock* block; std::vector<BasicBlock*> successors; size_t next; };
+    std::vector<LayoutFrame> stack;
+    auto visit = [&](BasicBlock* block) {
+        visited.insert(block);
+        std::vector<BasicBlock*> successors(block->successors.rbegin(), block->successors.rend());
+        if (successors.size() > 1 && leavesLoop(block, successors.back())) {
+            auto staying = std::find_if(successors.begin(), successors.end(), [&](BasicBlock* succ) { return !leavesLoop(block, succ); });
+            if (staying != successors.end()) std::rotate(staying, staying + 1, successors.end());
+        }
+        stack.push_back({block, successors, 0});
+    };
+    visit(function->entry());
+    while (!stack.empty()) {
+        LayoutFrame &frame = stack.back();
+        if (frame.next < frame.successors.size()) {
+            BasicBlock* succ = frame.successors[frame.next++];
+            if (succ && !visited.count(succ)) visit(succ);
+            continue;
+        }
+        postorder.push_back(frame.block);
+        stack.pop_back();
+    }
+    std::vector<BasicBlock*> order(postorder.rbegin(), postorder.rend());
+
+    for (const Loop &loop : loops) {
+        // A header that tests, entered again by a goto from the last block of the loop and
+        // followed by the exit, moves below that block: the goto disappears and the test
+        // branches back to the body when it holds.
+        if (loop.header->instructions.empty() || loop.header->instructions.back().kind != Instruction::IfFalse) continue;
+        size_t first = std::find(order.begin(), order.end(), loop.header) - order.begin();
+        size_t last = first + loop.body.size() - 1;
+        if (last + 1 >= order.size()) continue;
+        bool contiguous = true;
+        for (size_t i = first; i <= last && contiguous; i++) contiguous = loop.body.count(order[i]) > 0;
+        const BasicBlock* latch = order[last];
+        BasicBlock* after = order[last + 1];
+        if (!contiguous || latch == loop.header || latch->instructions.empty() ||
+            latch->instructions.back().kind != Instruction::Goto || latch->instructions.back().target != loop.header ||
+            std::find(loop.header->successors.begin(), loop.header->successors.end(), after) == loop.header->successors.end())
+            continue;
+        std::rotate(order.begin() + first, order.begin() + first + 1, order.begin() + last + 1);
+    }
+    return order;
+}
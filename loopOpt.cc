@@ -0,0 +1,239 @@
+// Loop optimisations on the SSA form: natural-loop detection, preheader insertion,
+// loop-invariant code motion and strength reduction of induction-variable products.
+#include <unordered_map>
+
+struct Loop {
+    BasicBlock* header;
+    std::set<BasicBlock*> body;        // Includes the header.
+    std::vector<BasicBlock*> latches;  // Sources of the back edges.
+};
+
+// Finds the natural loops of a function, innermost first. Loops sharing a header are merged.
+static std::vector<Loop> findLoops(Function* function) {
+    std::vector<Loop> loops;
+    std::map<BasicBlock*, size_t> byHeader;
+    for (BasicBlock* block : function->blocks) {
+        for (BasicBlock* header : block->successors) {
+            if (!IR::dominates(header, block)) continue;
+            auto found = byHeader.find(header);
+            if (found == byHeader.end()) {
+                found = byHeader.insert({header, loops.size()}).first;
+                loops.push_back({header, {header}, {}});
+            }
+            Loop &loop = loops[found->second];
+            loop.latches.push_back(block);
+            std::vector<BasicBlock*> work;
+            if (loop.body.insert(block).second) work.push_back(block);
+            while (!work.empty()) {
+                BasicBlock* member = work.back();
+                work.pop_back();
+                for (BasicBlock* pred : member->predecessors)
+                    if (loop.body.insert(pred).second) work.push_back(pred);
+            }
+        }
+    }
+    std::stable_sort(loops.begin(), loops.end(), [](const Loop &a, const Loop &b) {
+        return a.body.size() < b.body.size();
+    });
+    return loops;
+}
+
+// Returns the single block through which the loop is entered, splitting the entering
+// edge when its source has other successors. Returns nullptr when the loop is entered
+// from several blocks.
+BasicBlock* IR::ensurePreheader(Function* function, BasicBlock* header, const std::set<BasicBlock*> &body) {
+    BasicBlock* outside = nullptr;
+    for (BasicBlock* pred : header->predecessors) {
+        if (body.count(pred)) continue;
+        if (outside) return nullptr;
+        outside = pred;
+    }
+    if (!outside) return nullptr;
+    if (outside->successors.size() == 1) return outside;
+
+    BasicBlock* preheader = createBlock(function);
+    preheader->addInstruction(Instruction(Instruction::Goto, "", "", {}, header, "preheader"));
+    preheader->addSuccessor(header);
+    preheader->predecessors.push_back(outside);
+    for (BasicBlock* &succ : outside->successors)
+        if (succ == header) succ = preheader;
+    Instruction &branch = outside->instructions.back();
+    if (branch.target == header) branch.target = preheader;
+    std::replace(header->predecessors.begin(), header->predecessors.end(), outside, preheader);
+    for (Instruction &inst : header->instructions) {
+        if (inst.kind != Instruction::Phi) break;
+        std::replace(inst.sources.begin(), inst.sources.end(), outside, preheader);
+    }
+    return preheader;
+}
+
+// Inserts an instruction at the end of a block, before its terminator.
+static void insertBeforeTerminator(BasicBlock* block, const Instruction &inst) {
+    auto pos = block->instructions.end();
+    if (!block->instructions.empty() && block->instructions.back().isTerminator()) --pos;
+    block->instructions.insert(pos, inst);
+}
+
+static bool isPure(const Instruction &inst) {
+    return inst.kind == Instruction::Const || inst.kind == Instruction::Copy ||
+           inst.kind == Instruction::Unary || inst.kind == Instruction::Binary;
+}
+
+// Hoists invariant computations out of every loop and replaces products of a basic
+// induction variable and an invariant with an added running value. Runs on SSA form;
+// returns the number of instructions moved or rewritten.
+int IR::optimizeLoops() {
+    int changes = 0;
+    for (Function* function : functions) {
+        if (!function->inSSA) continue;
+        computePredecessors(function);
+        computeDominators(function);
+        std::vector<Loop> loops = findLoops(function);
+        if (loops.empty()) continue;
+
+        // Block defining each SSA name. Fields may be assigned several times; a call
+        // may assign any of them.
+        std::unordered_map<std::string, BasicBlock*> defBlock;
+        for (BasicBlock* block : function->blocks)
+            for (const Instruction &inst : block->instructions)
+                if (!inst.dst.empty()) defBlock[inst.dst] = block;
+
+        for (Loop &loop : loops) {
+            BasicBlock* preheader = ensurePreheader(function, loop.header, loop.body);
+            if (!preheader) continue;
+            if (preheader->rpoIndex == -1) {
+                // A new block on the entering edge belongs to every loop around that edge.
+                preheader->rpoIndex = loop.header->rpoIndex;
+                for (Loop &outer : loops)
+                    if (outer.body.count(loop.header) && outer.body.count(preheader->predecessors[0]))
+                        outer.body.insert(preheader);
+            }
+
+            bool hasCall = false;
+            std::set<std::string> storedFields;
+            for (BasicBlock* block : loop.body)
+                for (const Instruction &inst : block->instructions) {
+                    if (inst.kind == Instruction::Call) hasCall = true;
+                    if (!inst.dst.empty() && function->isField(inst.dst)) storedFields.insert(inst.dst);
+                }
+            auto invariant = [&](const std::string &name) {
+                if (function->isField(name)) return !hasCall && !storedFields.count(name);
+                auto def = defBlock.find(name);
+                return def == defBlock.end() || !loop.body.count(def->second);
+            };
+
+            // Loop-invariant code motion, in dominance order so operands move before their uses.
+            std::vector<BasicBlock*> order(loop.body.begin(), loop.body.end());
+            std::sort(order.begin(), order.end(), [](BasicBlock* a, BasicBlock* b) { return a->rpoIndex < b->rpoIndex; });
+            bool moved = true;
+            while (moved) {
+                moved = false;
+                for (BasicBlock* block : order) {
+                    size_t hoisted = block->removeInstructions([&](const Instruction &inst) {
+                        // Moving "x.2 = $t6" would only stretch x.2 over versions of x defined in
+                        // the loop, costing copies when SSA is left; copy propagation does better.
+                        bool assignsLocal = inst.kind == Instruction::Copy && !isTempName(inst.dst);
+                        if (!isPure(inst) || assignsLocal || function->isField(inst.dst) ||
+                            !std::all_of(inst.args.begin(), inst.args.end(), invariant))
+                            return false;
+                        insertBeforeTerminator(preheader, inst);
+                        defBlock[inst.dst] = preheader;
+                        return true;
+                    });
+                    if (hoisted) {
+                        moved = true;
+                        changes += hoisted;
+                        function->optCounts["licm_hoisted"] += hoisted;
+                    }
+                }
+            }
+
+            // Strength reduction needs a single back edge to carry the running products.
+            if (loop.latches.size() != 1) continue;
+            BasicBlock* latch = loop.latches[0];
+
+            auto definition = [&](const std::string &name) -> const Instruction* {
+                auto def = defBlock.find(name);
+                if (def == defBlock.end()) return nullptr;
+                for (const Instruction &inst : def->second->instructions)
+                    if (inst.dst == name) return &inst;
+                return nullptr;
+            };
+            // Follows assignments such as "i.3 = $t15" to the computation behind them.
+            auto origin = [&](std::string name) -> const Instruction* {
+                const Instruction* inst = definition(name);
+                while (inst && inst->kind == Instruction::Copy && !function->isField(inst->args[0])) {
+                    const Instruction* next = definition(inst->args[0]);
+                    if (!next) break;
+                    inst = next;
+                }
+                return inst;
+            };
+
+            // Basic induction variables: i = phi(init, i + step) with an invariant step.
+            struct Induction { std::string init, step, op, next; };
+            std::map<std::string, Induction> inductions;
+            for (const Instruction &phi : loop.header->instructions) {
+                if (phi.kind != Instruction::Phi) break;
+                if (phi.sources.size() != 2) continue;
+                size_t back = phi.sources[0] == latch ? 0 : 1;
+                if (phi.sources[back] != latch || phi.sources[1 - back] != preheader) continue;
+                const Instruction* update = origin(phi.args[back]);
+                if (!update || update->kind != Instruction::Binary || !loop.body.count(defBlock[update->dst])) continue;
+                if (update->op == "+" && update->args[1] == phi.dst && invariant(update->args[0]))
+                    inductions[phi.dst] = {phi.args[1 - back], update->args[0], "+", update->dst};
+                else if ((update->op == "+" || update->op == "-") && update->args[0] == phi.dst && invariant(update->args[1]))
+                    inductions[phi.dst] = {phi.args[1 - back], update->args[1], update->op, update->dst};
+            }
+            if (inductions.empty()) continue;
+
+            // Each product i * k becomes a running value r = phi(init * k, r + step * k).
+            std::map<std::pair<std::string, std::string>, std::string> reduced;
+            std::map<std::string, std::pair<std::string, std::string>> products;
+            for (BasicBlock* block : order) {
+                for (const Instruction &inst : block->instructions) {
+                    if (inst.kind != Instruction::Binary || inst.op != "*") continue;
+                    int ivSide = inductions.count(inst.args[0]) ? 0 : inductions.count(inst.args[1]) ? 1 : -1;
+                    if (ivSide < 0 || !invariant(inst.args[1 - ivSide])) continue;
+                    products[inst.dst] = {inst.args[ivSide], inst.args[1 - ivSide]};
+                    reduced[products[inst.dst]] = "";
+                }
+            }
+            for (auto &product : reduced) {
+                const Induction &induction = inductions[product.first.first];
+                const std::string &factor = product.first.second;
+                // Versions of one new variable, so leaving SSA needs no copies for the phi.
+                std::string base = newTemp(), increment = newTemp();
+                std::string start = base + ".1", running = product.second = base + ".2", next = base + ".3";
+                insertBeforeTerminator(preheader, Instruction(Instruction::Binary, start, "*", {induction.init, factor}));
+                insertBeforeTerminator(preheader, Instruction(Instruction::Binary, increment, "*", {induction.step, factor}));
+                Instruction phi(Instruction::Phi, running, base, {start, next});
+                phi.sources = {preheader, latch};
+                loop.header->instructions.insert(loop.header->instructions.begin(), phi);
+                BasicBlock* updateBlock = defBlock[induction.next];
+                auto &updateInsts = updateBlock->instructions;
+                for (size_t i = 0; i < updateInsts.size(); i++) {
+                    if (updateInsts[i].dst != induction.next) continue;
+                    updateInsts.insert(updateInsts.begin() + i + 1,
+                                       Instruction(Instruction::Binary, next, induction.op, {running, increment}));
+                    break;
+                }
+                defBlock[start] = defBlock[increment] = preheader;
+                defBlock[running] = loop.header;
+                defBlock[next] = updateBlock;
+            }
+            for (BasicBlock* block : order) {
+                for (Instruction &inst : block->instructions) {
+                    auto product = products.find(inst.dst);
+                    if (product == products.end() || inst.kind != Instruction::Binary) continue;
+                    inst = Instruction(Instruction::Copy, inst.dst, "", {reduced[product->second]}, nullptr, "strength reduced");
+                    changes++;
+                    function->optCounts["strength_reduced"]++;
+                }
+            }
+        }
+        computePredecessors(function);
+        computeDominators(function);
+    }
+    return changes;
+}
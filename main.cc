@@ -1,15 +1,38 @@
 #include <iostream>
 #include <fstream>
+#include <chrono>
+#include <sstream>
+#include <unordered_map>
+#include <unordered_set>
+#include <csignal>
+#include <cstring>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
 #include "parser.tab.hh"
 #include "symbolT.cc"
 #include "Node.h"
 #include "IR.cc"  // Contains both low-level TAC generators and high-level code generator functions
+#include "SSA.cc" // Dominators and SSA construction over the IR
+#include "loopOpt.cc"
+#include "GVN.cc"
+#include "inline.cc"
+#include "tailcall.cc"
+#include "layout.cc"
+#include "slots.cc"
+#include "stream.cc" // --single-pass: methods translated as they are parsed
 
 extern Node* root;
 extern FILE* yyin;
 extern int yylineno;
 extern int lexical_errors;
+extern std::unordered_set<std::string> internedTokens;
 extern yy::parser::symbol_type yylex();
+extern void yyrestart(FILE *input);
 
 enum errCodes {
     SUCCESS = 0,
@@ -17,11 +40,45 @@ enum errCodes {
     SYNTAX_ERROR = 2,
     AST_ERROR = 3,
     SEMANTIC_ERROR = 4,
+    IR_ERROR = 5,
     SEGMENTATION_FAULT = 139
 };
 
 int errCode = errCodes::SUCCESS;
 
+// Artefacts selected with --emit=. Only the bytecode is produced by default;
+// the DOT dumps and the symbol table listing are debugging aids.
+struct EmitOptions {
+    bool tree = false;
+    bool cfg = false;
+    bool symbols = false;
+    bool ssa = false;
+    bool bytecode = true;
+};
+
+// Parses a comma separated list such as "tree,cfg,bytecode". Returns false on an unknown name.
+bool parseEmitList(const std::string &list, EmitOptions &emit) {
+    emit = EmitOptions();
+    emit.bytecode = false;
+    size_t start = 0;
+    while (start <= list.size()) {
+        size_t end = list.find(',', start);
+        if (end == std::string::npos) end = list.size();
+        std::string name = list.substr(start, end - start);
+        if (name == "tree") emit.tree = true;
+        else if (name == "cfg") emit.cfg = true;
+        else if (name == "symbols") emit.symbols = true;
+        else if (name == "ssa") emit.ssa = true;
+        else if (name == "bytecode") emit.bytecode = true;
+        else if (!name.empty()) {
+            std::cerr << "Unknown --emit artefact '" << name << "' (expected tree, cfg, ssa, symbols or bytecode)" << std::endl;
+            return false;
+        }
+        start = end + 1;
+    }
+    return true;
+}
+
 // This error method is invoked by the parser when a syntax error occurs.
 void yy::parser::error(std::string const &err) {
     if (!lexical_errors) {
@@ -34,19 +91,214 @@ void yy::parser::error(std::string const &err) {
     }
 }
 
-int main(int argc, char **argv) {
-    // Open input file if provided.
-    if (argc > 1) {
-        if (!(yyin = fopen(argv[1], "r"))) {
-            perror(argv[1]);
-            return 1;
+// Wall time spent in each compiler phase, reported on stderr with --phase-times, and the
+// process's memory at the end of each phase, reported with --phase-memory.
+class PhaseTimer {
+public:
+    struct Phase {
+        std::string name;
+        double seconds;
+        long peakKb;    // Peak resident set size of the process so far.
+        long rssKb;     // Resident set size when the phase ended.
+    };
+    std::vector<Phase> phases;
+    std::chrono::steady_clock::time_point last = std::chrono::steady_clock::now();
+
+    // Closes the phase that started at the previous mark.
+    void mark(const std::string &name) {
+        auto now = std::chrono::steady_clock::now();
+        rusage usage;
+        getrusage(RUSAGE_SELF, &usage);
+        long pages = 0, resident = 0;
+        if (FILE *statm = fopen("/proc/self/statm", "r")) {
+            if (fscanf(statm, "%ld %ld", &pages, &resident) != 2) resident = 0;
+            fclose(statm);
         }
+        phases.push_back({name, std::chrono::duration<double>(now - last).count(), usage.ru_maxrss,
+                          resident * (sysconf(_SC_PAGESIZE) / 1024)});
+        last = now;
     }
-    
+
+    void print(std::ostream &out) const {
+        out << "phases:";
+        for (const Phase &phase : phases)
+            out << " " << phase.name << "_s=" << phase.seconds;
+        out << std::endl;
+    }
+
+    void printMemory(std::ostream &out) const {
+        out << "memory:";
+        for (const Phase &phase : phases)
+            out << " " << phase.name << "_peak_kB=" << phase.peakKb << " " << phase.name << "_rss_kB=" << phase.rssKb;
+        out << std::endl;
+    }
+};
+
+// Compiler settings, from the command line or from a compile server request.
+struct CompileOptions {
+    EmitOptions emit;
+    bool phaseTimes = false;
+    bool phaseMemory = false;
+    bool optimize = false;
+    bool optReport = false;
+    bool singlePass = false;
+    size_t inlineBudget = 16;  // Largest method, in instructions, that -O inlines.
+};
+
+// Applies 'arg' to 'options' if it is an option. Returns false for anything else, such as
+// the input file; 'valid' is cleared for an option with a bad value.
+bool parseOption(const std::string &arg, CompileOptions &options, bool &valid) {
+    if (arg.rfind("--emit=", 0) == 0) {
+        if (!parseEmitList(arg.substr(7), options.emit))
+            valid = false;
+    } else if (arg == "--phase-times") {
+        options.phaseTimes = true;
+    } else if (arg == "--phase-memory") {
+        options.phaseMemory = true;
+    } else if (arg == "-O") {
+        options.optimize = true;
+    } else if (arg == "--single-pass") {
+        options.singlePass = true;
+    } else if (arg == "--opt-report") {
+        options.optReport = true;
+    } else if (arg.rfind("--inline-budget=", 0) == 0) {
+        options.inlineBudget = std::strtoul(arg.c_str() + 16, nullptr, 10);
+    } else {
+        return false;
+    }
+    return true;
+}
+
+// Everything after the IR is built: tail calls, the optimisation passes, the dumps and the
+// bytecode, which goes to 'bytecode', or to output.class when there is none. A program whose
+// IR or bytecode could not be generated gets no bytecode at all and the IR_ERROR status.
+void emitProgram(IR &ir, const CompileOptions &options, std::ostream *bytecode, PhaseTimer &timer) {
+    const EmitOptions &emit = options.emit;
+    if (ir.errorOccurred) {
+        errCode = errCodes::IR_ERROR;
+        return;
+    }
+    ir.eliminateTailCalls();   // Self-recursion in tail position runs in one frame
+    timer.mark("ir");
+    if (emit.cfg) {
+        ir.printCFG("ir.dot");     // Write the CFG to ir.dot
+        timer.mark("cfg");
+    }
+    if (options.optimize && options.inlineBudget > 0) {
+        ir.inlineCalls(options.inlineBudget);
+        timer.mark("inline");
+    }
+    if (emit.ssa || options.optimize) {
+        ir.buildSSA();
+        timer.mark("ssa");
+    }
+    if (options.optimize) {
+        ir.numberValues();
+        ir.optimizeLoops();
+        ir.numberValues();     // Merges what loop optimisation moved into the preheaders
+        timer.mark("opt");
+        if (options.optReport) {
+            for (Function *function : ir.functions) {
+                std::cerr << "opt: " << function->name;
+                for (const auto &count : function->optCounts)
+                    std::cerr << " " << count.first << "=" << count.second;
+                std::cerr << std::endl;
+            }
+        }
+    }
+    if (emit.ssa)
+        ir.printCFG("ssa.dot");    // The same CFG with phi nodes and numbered versions
+    if (emit.bytecode) {
+        // Collected first, so that a failure leaves no output.class behind.
+        std::ostringstream code;
+        ir.generateBytecode(code);
+        if (ir.errorOccurred) {
+            errCode = errCodes::IR_ERROR;
+        } else if (bytecode) {
+            *bytecode << code.str();   // The compile server's client writes it.
+            std::cout << "Bytecode written to output.class\n";
+        } else if (std::ofstream("output.class") << code.str()) {
+            std::cout << "Bytecode written to output.class\n";
+        } else {
+            std::cerr << "Error opening output.class" << std::endl;
+            errCode = errCodes::IR_ERROR;
+        }
+        timer.mark("bytecode");
+    }
+}
+
+// compile() for --single-pass, see stream.cc. Produces the same bytecode, but there is no
+// whole-program tree to dump, and the source is parsed twice.
+int compileSinglePass(const CompileOptions &options, std::ostream *bytecode, PhaseTimer &timer) {
+    if (options.emit.tree)
+        std::cerr << "--emit=tree is not available with --single-pass" << std::endl;
+    std::unique_ptr<SymbolTable> symbolTable(new SymbolTable());
+    IR ir;
+    std::unique_ptr<SinglePassCompiler> compiler(new SinglePassCompiler(*symbolTable, ir));
+
+    std::cout << "\nBuilding the symbol table...\n";
+    bool parseSuccess = compiler->prescan();
+    timer.mark("prescan");
+    if (parseSuccess && !lexical_errors) {
+        std::cout << "\nPerforming semantic analysis and generating IR per method...\n";
+        parseSuccess = compiler->translate();
+        timer.mark("stream");
+    }
+    compiler.reset();   // Frees the skeleton.
+    if (lexical_errors)
+        errCode = errCodes::LEXICAL_ERROR;
+
+    if (parseSuccess && !lexical_errors) {
+        if (options.emit.symbols) {
+            std::cout << "\nSymbol Table:\n";
+            printSymbolTable(*symbolTable);
+        }
+        bool semanticErrors = symbolTable->hasErrors();
+        if (semanticErrors) {
+            std::cout << "\nSemantic Errors:\n";
+            symbolTable->printErrors();
+            errCode = errCodes::SEMANTIC_ERROR;
+        }
+        symbolTable.reset();
+        if (!semanticErrors) {
+            std::cout << "\nNo semantic errors found.\n";
+            emitProgram(ir, options, bytecode, timer);
+        }
+    }
+
+    if (options.phaseTimes)
+        timer.print(std::cerr);
+    if (options.phaseMemory)
+        timer.printMemory(std::cerr);
+    return errCode;
+}
+
+// Compiles the program yyin reads and returns the exit status. The bytecode goes to
+// 'bytecode', or to output.class when there is none. Everything the previous compile left
+// in the scanner, parser and semantic analysis globals is reset first, so one process can
+// compile any number of programs.
+int compile(const CompileOptions &options, std::ostream *bytecode) {
+    const EmitOptions &emit = options.emit;
+    PhaseTimer timer;
+    errCode = errCodes::SUCCESS;
+    lexical_errors = 0;
+    internedTokens.clear();    // The nodes hold copies of the spellings.
+    yylineno = 1;
+    root = nullptr;
+    whatClassWeAreInRn = "";
+    if (options.singlePass)
+        return compileSinglePass(options, bytecode, timer);
+
+    // Each phase's data is released as soon as the next phase has what it needs: the symbol
+    // table once semantic analysis has resolved every call into the tree, and the tree once
+    // the IR is built.
     yy::parser parser;
-    SymbolTable *symbolTable = new SymbolTable(); // Create and initialize symbol table
+    std::unique_ptr<SymbolTable> symbolTable(new SymbolTable());
 
     bool parseSuccess = !parser.parse();
+    TreePtr tree(root);
+    root = nullptr;
+    timer.mark("parse");
     
     if (lexical_errors)
         errCode = errCodes::LEXICAL_ERROR;
@@ -54,32 +306,43 @@ int main(int argc, char **argv) {
     if (parseSuccess && !lexical_errors) {
         std::cout << "\nThe compiler successfully generated a syntax tree!\n";
         try {
-            // Generate the AST and output it as a DOT file (tree.dot).
-            root->generate_tree();
+            // Output the AST as a DOT file (tree.dot).
+            if (emit.tree) {
+                tree->generate_tree();
+                timer.mark("tree");
+            }
             
             // Build the symbol table from the AST.
             std::cout << "\nBuilding the symbol table...\n";
-            traverseTree(root, *symbolTable);
+            traverseTree(tree.get(), *symbolTable);
+            timer.mark("symbols");
             
             // Perform semantic analysis.
             std::cout << "\nPerforming semantic analysis...\n";
-            performSemanticAnalysis(root, *symbolTable);
+            performSemanticAnalysis(tree.get(), *symbolTable);
+            timer.mark("semantic");
             
-            std::cout << "\nSymbol Table:\n";
-            printSymbolTable(*symbolTable);
+            if (emit.symbols) {
+                std::cout << "\nSymbol Table:\n";
+                printSymbolTable(*symbolTable);
+            }
             
-            if (symbolTable->hasErrors()) {
+            bool semanticErrors = symbolTable->hasErrors();
+            if (semanticErrors) {
                 std::cout << "\nSemantic Errors:\n";
                 symbolTable->printErrors();
-            } else {
+                errCode = errCodes::SEMANTIC_ERROR;
+            }
+            symbolTable.reset();
+            if (!semanticErrors) {
                 std::cout << "\nNo semantic errors found.\n";
                 
                 // --- IR Generation Phase ---
                 std::cout << "\nGenerating Intermediate Representation (IR)...\n";
                 IR ir;
-                ir.start(root);            // Build TAC from AST
-                ir.printCFG("ir.dot");     // Write the CFG to ir.dot
-                ir.generateBytecode("output.class");
+                ir.start(tree.get());      // Build TAC from AST
+                tree.reset();
+                emitProgram(ir, options, bytecode, timer);
             }
         }
         catch (...) {
@@ -87,5 +350,306 @@ int main(int argc, char **argv) {
         }
     }
 
+    if (options.phaseTimes)
+        timer.print(std::cerr);
+    if (options.phaseMemory)
+        timer.printMemory(std::cerr);
     return errCode;
 }
+
+// Compile server. "--serve=SOCKET" listens on a Unix domain socket and compiles one program
+// per connection, in this process, so a compile pays neither process start-up nor parser
+// and allocator warm-up. A request is a line of compiler options followed by the source, up
+// to the end of the stream. The reply starts with "<status> <bytecode length> <stdout
+// length>", where the bytecode length is -1 when none was generated, followed by the
+// bytecode, what the compile printed to stdout and then what it printed to stderr.
+// "--connect=SOCKET" is the client side: it behaves like a local compile, writing
+// output.class and the diagnostics, but has the server do the work.
+//
+// The server handles one client at a time. A client that has not sent its whole request
+// within requestTimeoutSeconds, or sends more than requestSizeLimit bytes, is dropped without
+// a reply, and one that has not taken the whole reply within requestTimeoutSeconds is
+// dropped as well, so that it cannot hold up the others.
+//
+// Each compile runs in a child process, so that a compiler crash costs one reply rather than
+// the server, and whatever a compile leaves behind goes with the child.
+
+// Replies kept for repeated requests, which come back without compiling again.
+const size_t replyCacheLimit = 1024;
+const int requestTimeoutSeconds = 10;
+const size_t requestSizeLimit = 64 << 20;
+
+// When a transfer must be over, for the server's non-blocking client sockets.
+typedef std::chrono::steady_clock::time_point Deadline;
+const Deadline noDeadline = Deadline::max();
+
+// Waits until 'fd' is ready for 'events'. Returns false once 'deadline' has passed.
+static bool waitUntil(int fd, short events, Deadline deadline) {
+    for (;;) {
+        long long left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (left <= 0) return false;
+        pollfd entry = {fd, events, 0};
+        int ready = poll(&entry, 1, (int)std::min(left, 1000LL * requestTimeoutSeconds));
+        if (ready < 0 && errno != EINTR) return false;
+        if (ready > 0) return true;
+    }
+}
+
+static bool writeAll(int fd, const std::string &data, Deadline deadline = noDeadline) {
+    for (size_t done = 0; done < data.size(); ) {
+        ssize_t written = write(fd, data.data() + done, data.size() - done);
+        if (written < 0 && errno == EINTR) continue;
+        if (written < 0 && errno == EAGAIN && waitUntil(fd, POLLOUT, deadline)) continue;
+        if (written <= 0) return false;
+        done += written;
+    }
+    return true;
+}
+
+// Reads up to the end of the stream. Fails on a read error or timeout, or once more than
+// 'limit' bytes have come.
+static bool readAll(int fd, std::string &data, size_t limit = std::string::npos, Deadline deadline = noDeadline) {
+    char buffer[1 << 16];
+    for (;;) {
+        ssize_t got = read(fd, buffer, sizeof buffer);
+        if (got < 0 && errno == EINTR) continue;
+        if (got < 0 && errno == EAGAIN && waitUntil(fd, POLLIN, deadline)) continue;
+        if (got < 0) return false;
+        if (got == 0) return true;
+        if (data.size() + got > limit) return false;
+        data.append(buffer, got);
+    }
+}
+
+static bool socketAddress(const std::string &path, sockaddr_un &address) {
+    memset(&address, 0, sizeof address);
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof address.sun_path) {
+        std::cerr << "Socket path too long: " << path << std::endl;
+        return false;
+    }
+    strcpy(address.sun_path, path.c_str());
+    return true;
+}
+
+// Compiles one request and returns the reply. The diagnostics that compile() prints are
+// captured by pointing std::cout and std::cerr at strings while it runs.
+static std::string compileRequest(const std::string &request, bool &cacheable) {
+    size_t newline = request.find('\n');
+    std::istringstream args(request.substr(0, newline));
+    CompileOptions options;
+    std::string arg;
+    while (args >> arg) {
+        bool valid = true;
+        if (!parseOption(arg, options, valid) || !valid)
+            return "1 -1 0\nBad option in request: " + arg + "\n";
+    }
+    // Dumps are written to files, which a reply from the cache would not do.
+    cacheable = !options.emit.tree && !options.emit.cfg && !options.emit.ssa && !options.phaseTimes &&
+                !options.phaseMemory;
+    std::string source = newline == std::string::npos ? "" : request.substr(newline + 1);
+    yyin = fmemopen(&source[0], source.size(), "r");
+    if (!yyin)
+        return "1 -1 0\nCannot read the request\n";
+    yyrestart(yyin);
+
+    std::ostringstream bytecode, out, err;
+    std::streambuf *stdoutBuffer = std::cout.rdbuf(out.rdbuf());
+    std::streambuf *stderrBuffer = std::cerr.rdbuf(err.rdbuf());
+    int status = compile(options, &bytecode);
+    std::cout.rdbuf(stdoutBuffer);
+    std::cerr.rdbuf(stderrBuffer);
+    fclose(yyin);
+    yyin = nullptr;
+
+    std::string code = bytecode.str();
+    return std::to_string(status) + " " + (code.empty() ? "-1" : std::to_string(code.size())) + " " +
+           std::to_string(out.str().size()) + "\n" + code + out.str() + err.str();
+}
+
+// Runs compileRequest in a child process and returns its reply, or an error reply with
+// status 139 when the child does not finish normally.
+static std::string compileInChild(const std::string &request, bool &cacheable) {
+    cacheable = false;
+    int channel[2];
+    if (pipe(channel) < 0)
+        return "1 -1 0\nCannot start the compile\n";
+    pid_t child = fork();
+    if (child < 0) {
+        close(channel[0]);
+        close(channel[1]);
+        return "1 -1 0\nCannot start the compile\n";
+    }
+    if (child == 0) {
+        close(channel[0]);
+        bool childCacheable = false;
+        std::string reply = compileRequest(request, childCacheable);
+        _exit(writeAll(channel[1], (childCacheable ? "1" : "0") + reply) ? 0 : 1);
+    }
+    close(channel[1]);
+    std::string reply;
+    readAll(channel[0], reply);
+    close(channel[0]);
+    int status;
+    while (waitpid(child, &status, 0) < 0 && errno == EINTR) {}
+    if (!WIFEXITED(status) || WEXITSTATUS(status) != 0 || reply.empty()) {
+        std::string cause = WIFSIGNALED(status) ? std::string(strsignal(WTERMSIG(status))) : "no reply";
+        return std::to_string(SEGMENTATION_FAULT) + " -1 0\nThe compiler crashed (" + cause + ")\n";
+    }
+    cacheable = reply[0] == '1';
+    return reply.substr(1);
+}
+
+// The replies to the most recent requests, keyed by the whole request: a request that
+// differs from a cached one in any byte is compiled from scratch. The least recently used
+// reply is dropped once there are replyCacheLimit of them.
+class ReplyCache {
+public:
+    const std::string *find(const std::string &request) {
+        auto entry = replies.find(request);
+        if (entry == replies.end()) return nullptr;
+        order.splice(order.begin(), order, entry->second.use);
+        return &entry->second.reply;
+    }
+
+    void add(const std::string &request, const std::string &reply) {
+        if (replies.size() >= replyCacheLimit) {
+            replies.erase(replies.find(*order.back()));
+            order.pop_back();
+        }
+        auto entry = replies.emplace(request, Entry{reply, {}}).first;
+        order.push_front(&entry->first);
+        entry->second.use = order.begin();
+    }
+
+private:
+    struct Entry {
+        std::string reply;
+        std::list<const std::string *>::iterator use;   // Its place in 'order'.
+    };
+    std::unordered_map<std::string, Entry> replies;
+    std::list<const std::string *> order;   // Requests, most recently used first.
+};
+
+int serve(const std::string &path) {
+    signal(SIGPIPE, SIG_IGN);   // A client that goes away must not end the server.
+    sockaddr_un address;
+    if (!socketAddress(path, address))
+        return 1;
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    unlink(path.c_str());
+    if (listener < 0 || bind(listener, (sockaddr *)&address, sizeof address) < 0 || listen(listener, 64) < 0) {
+        perror(path.c_str());
+        return 1;
+    }
+    std::cerr << "Compile server listening on " << path << std::endl;
+    ReplyCache replies;
+    for (;;) {
+        int client = accept(listener, nullptr, nullptr);
+        if (client < 0) {
+            if (errno == EINTR) continue;
+            perror("accept");
+            return 1;
+        }
+        fcntl(client, F_SETFL, fcntl(client, F_GETFL) | O_NONBLOCK);
+        auto timeout = std::chrono::seconds(requestTimeoutSeconds);
+        std::string request;
+        if (readAll(client, request, requestSizeLimit, std::chrono::steady_clock::now() + timeout)) {
+            const std::string *cached = replies.find(request);
+            if (cached) {
+                writeAll(client, *cached, std::chrono::steady_clock::now() + timeout);
+            } else {
+                bool cacheable = false;
+                std::string reply = compileInChild(request, cacheable);
+                writeAll(client, reply, std::chrono::steady_clock::now() + timeout);
+                if (cacheable) replies.add(request, reply);
+            }
+        }
+        close(client);
+    }
+}
+
+// Sends the options in argv and the source in 'inputFile', or stdin, to the server at 'path'
+// and handles the reply as a local compile would: writes output.class, prints the
+// diagnostics and returns the compile's status.
+int compileRemotely(const std::string &path, int argc, char **argv, const char *inputFile) {
+    std::string request;
+    for (int i = 1; i < argc; i++)
+        if (argv[i] != inputFile && std::string(argv[i]).rfind("--connect=", 0) != 0)
+            request += std::string(argv[i]) + " ";
+    request += "\n";
+    std::ostringstream source;
+    if (inputFile) {
+        std::ifstream in(inputFile);
+        if (!in) {
+            perror(inputFile);
+            return 1;
+        }
+        source << in.rdbuf();
+    } else {
+        source << std::cin.rdbuf();
+    }
+    request += source.str();
+
+    sockaddr_un address;
+    if (!socketAddress(path, address))
+        return 1;
+    int server = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (server < 0 || connect(server, (sockaddr *)&address, sizeof address) < 0) {
+        perror(path.c_str());
+        return 1;
+    }
+    std::string reply;
+    bool sent = writeAll(server, request) && shutdown(server, SHUT_WR) == 0 && readAll(server, reply);
+    close(server);
+    int status;
+    long long codeLength, outLength;
+    size_t newline = reply.find('\n');
+    std::istringstream header(reply.substr(0, newline));
+    if (!sent || newline == std::string::npos || !(header >> status >> codeLength >> outLength) ||
+        reply.size() - newline - 1 < (size_t)std::max(codeLength, 0LL) + outLength) {
+        std::cerr << "No valid reply from the compile server at " << path << std::endl;
+        return 1;
+    }
+    size_t at = newline + 1;
+    if (codeLength >= 0) {
+        std::ofstream("output.class") << reply.substr(at, codeLength);
+        at += codeLength;
+    }
+    std::cout << reply.substr(at, outLength);
+    std::cerr << reply.substr(at + outLength);
+    return status;
+}
+
+int main(int argc, char **argv) {
+    CompileOptions options;
+    const char *inputFile = nullptr;
+    std::string servePath, connectPath;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool valid = true;
+        if (parseOption(arg, options, valid)) {
+            if (!valid)
+                return 1;
+        } else if (arg.rfind("--serve=", 0) == 0) {
+            servePath = arg.substr(8);
+        } else if (arg.rfind("--connect=", 0) == 0) {
+            connectPath = arg.substr(10);
+        } else {
+            inputFile = argv[i];
+        }
+    }
+    if (!servePath.empty())
+        return serve(servePath);
+    if (!connectPath.empty())
+        return compileRemotely(connectPath, argc, argv, inputFile);
+
+    // Open input file if provided.
+    if (inputFile) {
+        if (!(yyin = fopen(inputFile, "r"))) {
+            perror(inputFile);
+            return 1;
+        }
+    }
+    return compile(options, nullptr);
+}
@@ -0,0 +1,585 @@
+#include "mjvm.h"
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unordered_map>
+#include <chrono>
+#include <stdexcept>
+#include <iomanip>
+#include <limits>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#else
+#include <time.h>
+#endif
+
+namespace mjvm
+{
+
+const std::unordered_map<std::string, Opcode> opcodes = {
+    {"iconst", ICONST}, {"iload", ILOAD}, {"istore", ISTORE}, {"getfield", GETFIELD}, {"putfield", PUTFIELD},
+    {"new", NEW}, {"invoke", INVOKE}, {"ireturn", IRETURN},
+    {"iadd", IADD}, {"isub", ISUB}, {"imul", IMUL}, {"idiv", IDIV}, {"iand", IAND}, {"ior", IOR},
+    {"inot", INOT}, {"ieq", IEQ}, {"igt", IGT}, {"ilt", ILT}, {"print", PRINT},
+    {"goto", GOTO}, {"iffalse", IFFALSE}, {"iftrue", IFTRUE},
+    {"if_icmplt", IF_ICMPLT}, {"if_icmpge", IF_ICMPGE}, {"if_icmpgt", IF_ICMPGT},
+    {"if_icmple", IF_ICMPLE}, {"if_icmpeq", IF_ICMPEQ}, {"if_icmpne", IF_ICMPNE},
+    {"stop", STOP},
+};
+
+// Instructions run between two looks at the clock under a time limit.
+const long long pollInterval = 1 << 16;
+
+// Thrown when a run reaches one of its limits.
+struct ExecutionLimit : std::runtime_error
+{
+    using std::runtime_error::runtime_error;
+};
+
+static bool isJump(Opcode op)
+{
+    return op >= GOTO && op <= IF_ICMPNE;
+}
+
+static std::runtime_error errorAt(size_t line, const std::string& message)
+{
+    return std::runtime_error("line " + std::to_string(line) + ": " + message);
+}
+
+// Rejects anything left on a line after what it was expected to hold.
+static void expectEnd(std::istringstream& iss, size_t line)
+{
+    std::string rest;
+    if (iss >> rest) throw errorAt(line, "unexpected " + rest + " at the end of the line");
+}
+
+// Decodes the lines of a .class file, resolving labels to opcode indices.
+static void decode(Module& module, const std::vector<std::string>& lines)
+{
+    std::vector<Op>& code = module.code;
+    std::vector<Method>& methods = module.methods;
+    std::unordered_map<std::string, size_t> labels;     // "block_3" -> index of the opcode after "label block_3:"
+    std::vector<std::pair<size_t, std::string>> jumps;  // every jump and its label, resolved at the end
+    int line = 0;                                       // source line of the opcodes being read
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        std::istringstream iss(lines[i]);
+        std::string word;
+        if (!(iss >> word) || word.compare(0, 2, "//") == 0) continue;
+        if (word == ".method")
+        {
+            std::string slotsWord, paramsWord, stackWord;
+            Method method{"", code.size(), code.size(), 0, 0, 0, 0};
+            if (!(iss >> method.name >> slotsWord >> method.slots >> paramsWord >> method.params >> stackWord >> method.stack))
+                throw errorAt(i + 1, "malformed method header");
+            expectEnd(iss, i + 1);
+            if (!methods.empty()) methods.back().end = code.size();
+            methods.push_back(method);
+            module.maxStack = std::max(module.maxStack, method.stack);
+            module.blocks.push_back({"entry", methods.size() - 1});
+            line = 0;
+            module.regions.push_back({module.blocks.size() - 1, line});
+            continue;
+        }
+        if (word == ".line")
+        {
+            if (!(iss >> line) || line < 0) throw errorAt(i + 1, ".line needs a line number");
+            expectEnd(iss, i + 1);
+            if (!methods.empty()) module.regions.push_back({module.blocks.size() - 1, line});
+            continue;
+        }
+        if (word == "label")
+        {
+            std::string name;
+            iss >> name;
+            if (!name.empty() && name.back() == ':') name.pop_back();
+            expectEnd(iss, i + 1);
+            if (!labels.insert({name, code.size()}).second) throw errorAt(i + 1, "label " + name + " defined twice");
+            if (!methods.empty())
+            {
+                module.blocks.push_back({name, methods.size() - 1});
+                module.regions.push_back({module.blocks.size() - 1, line});
+            }
+            continue;
+        }
+        if (methods.empty()) throw errorAt(i + 1, "code outside a method");
+        auto found = opcodes.find(word);
+        if (found == opcodes.end()) throw errorAt(i + 1, "unknown opcode " + word);
+        Op op{found->second, 0};
+        if (isJump(op.code))
+        {
+            std::string target;
+            iss >> target;
+            if (target == "goto") iss >> target;
+            jumps.push_back({code.size(), target});
+        }
+        else if (op.code <= INVOKE && !(iss >> op.arg))
+            throw errorAt(i + 1, word + " needs a number");
+        expectEnd(iss, i + 1);
+        code.push_back(op);
+        module.codeLines.push_back(i + 1);
+        module.blockOf.push_back(module.blocks.size() - 1);
+        module.regionOf.push_back(module.regions.size() - 1);
+    }
+    if (!methods.empty()) methods.back().end = code.size();
+    for (const auto& jump : jumps)
+    {
+        auto target = labels.find(jump.second);
+        if (target == labels.end()) throw errorAt(module.codeLines[jump.first], "no label " + jump.second);
+        const Method& method = methods[module.blocks[module.blockOf[jump.first]].method];
+        if (target->second < method.entry || target->second >= method.end)
+            throw errorAt(module.codeLines[jump.first], method.name + " jumps to " + jump.second + ", a label outside it");
+        code[jump.first].arg = (int)target->second;
+    }
+}
+
+// Checks every method once, so that running it needs no checks per instruction. On every
+// path into an instruction the operand stack has the same depth; it never underflows,
+// never exceeds the depth in the header and holds nothing of the caller's under a call.
+// Slots, methods and jump targets exist, and no path runs off the end of its method; decode
+// has already checked that every jump stays in its method.
+// Also counts the fields each method uses, which a call checks its receiver against.
+static void verify(Module& module)
+{
+    std::vector<Method>& methods = module.methods;
+    const std::vector<size_t>& codeLines = module.codeLines;
+    if (methods.empty() || methods[0].name != "main" || methods[0].params != 0)
+        throw std::runtime_error("the first method must be main, without parameters");
+    for (size_t m = 0; m < methods.size(); m++)
+    {
+        Method& method = methods[m];
+        if (method.entry == method.end)
+            throw std::runtime_error(method.name + " has no code");
+        if (m > 0 && method.params + 1 > method.slots)
+            throw std::runtime_error(method.name + ": frame too small for the receiver and parameters");
+
+        std::vector<int> depthAt(method.end - method.entry, -1);   // -1 until reached
+        std::vector<size_t> work;
+        auto reach = [&](size_t pc, int depth, size_t from) {
+            if (pc < method.entry || pc >= method.end)
+                throw errorAt(codeLines[from], method.name + " continues past its end");
+            int& known = depthAt[pc - method.entry];
+            if (known == depth) return;
+            if (known >= 0)
+                throw errorAt(codeLines[pc], "stack depth " + std::to_string(depth) + " on one path and " +
+                                             std::to_string(known) + " on another");
+            known = depth;
+            work.push_back(pc);
+        };
+        reach(method.entry, 0, method.entry);
+        while (!work.empty())
+        {
+            size_t pc = work.back();
+            work.pop_back();
+            const Op& op = module.code[pc];
+            int depth = depthAt[pc - method.entry];
+            int pops = 0, pushes = 0;
+            switch (op.code)
+            {
+                case ICONST: pushes = 1; break;
+                case NEW:
+                    if (op.arg < 0) throw errorAt(codeLines[pc], "negative field count");
+                    pushes = 1;
+                    break;
+                case ILOAD: case ISTORE:
+                    if (op.arg < 0 || (size_t)op.arg >= method.slots) throw errorAt(codeLines[pc], "no slot " + std::to_string(op.arg));
+                    if (op.code == ILOAD) pushes = 1; else pops = 1;
+                    break;
+                case GETFIELD: case PUTFIELD:
+                    if (m == 0 || op.arg < 0) throw errorAt(codeLines[pc], "no field " + std::to_string(op.arg));
+                    method.fields = std::max(method.fields, (size_t)op.arg + 1);
+                    if (op.code == GETFIELD) pushes = 1; else pops = 1;
+                    break;
+                case INVOKE:
+                    if (op.arg <= 0 || (size_t)op.arg >= methods.size()) throw errorAt(codeLines[pc], "no method " + std::to_string(op.arg) + " to call");
+                    pops = methods[op.arg].params + 1;
+                    pushes = 1;
+                    if (depth > pops) throw errorAt(codeLines[pc], "operands left below a call");
+                    break;
+                case IRETURN:
+                    if (m == 0) throw errorAt(codeLines[pc], "main cannot return");
+                    if (depth > 1) throw errorAt(codeLines[pc], "operands left below the result");
+                    pops = 1;
+                    break;
+                case IADD: case ISUB: case IMUL: case IDIV: case IAND: case IOR: case IEQ: case IGT: case ILT:
+                    pops = 2; pushes = 1; break;
+                case INOT: pops = 1; pushes = 1; break;
+                case PRINT: case IFFALSE: case IFTRUE: pops = 1; break;
+                case IF_ICMPLT: case IF_ICMPGE: case IF_ICMPGT: case IF_ICMPLE: case IF_ICMPEQ: case IF_ICMPNE: pops = 2; break;
+                case GOTO: case STOP: break;
+            }
+            if (depth < pops) throw errorAt(codeLines[pc], "stack underflow");
+            depth += pushes - pops;
+            if ((size_t)depth > method.stack)
+                throw errorAt(codeLines[pc], "stack deeper than the " + std::to_string(method.stack) + " in the header");
+            if (op.code == STOP || op.code == IRETURN) continue;
+            if (isJump(op.code)) reach(op.arg, depth, pc);
+            if (op.code != GOTO) reach(pc + 1, depth, pc);
+        }
+    }
+}
+
+std::shared_ptr<const Module> load(const std::vector<std::string>& lines)
+{
+    std::shared_ptr<Module> module = std::make_shared<Module>();
+    decode(*module, lines);
+    verify(*module);
+    return module;
+}
+
+std::shared_ptr<const Module> loadFile(const std::string& fileName)
+{
+    std::ifstream inputFile(fileName);
+    if (!inputFile) throw std::runtime_error("cannot open " + fileName);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(inputFile, line))
+        lines.push_back(line);
+    return load(lines);
+}
+
+Profile::Profile(const Module& module)
+    : blockEntries(module.blocks.size()), regionInstructions(module.regions.size()),
+      regionCycles(module.regions.size()), callPaths{{0, 0, 0}}
+{
+}
+
+// Clock for profiles: the CPU's cycle counter where there is one, nanoseconds otherwise.
+static inline unsigned long long ticks()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return now.tv_sec * 1000000000ull + now.tv_nsec;
+#endif
+}
+
+// Throws once a run that has executed 'executed' instructions since 'begin' has reached one
+// of its limits, and otherwise returns the count at which to check again: the instruction
+// limit or, under a time limit, the next poll of the clock.
+static long long nextCheckpoint(const Limits& limits, long long executed, std::chrono::steady_clock::time_point begin)
+{
+    if (limits.maxInstructions && executed >= limits.maxInstructions)
+        throw ExecutionLimit("instruction limit of " + std::to_string(limits.maxInstructions) + " reached");
+    long long checkpoint = limits.maxInstructions ? limits.maxInstructions : std::numeric_limits<long long>::max();
+    if (limits.timeout > 0)
+    {
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - begin;
+        if (elapsed.count() >= limits.timeout)
+        {
+            std::ostringstream message;
+            message << "time limit of " << limits.timeout << " s reached";
+            throw ExecutionLimit(message.str());
+        }
+        checkpoint = std::min(checkpoint, executed + pollInterval);
+    }
+    return checkpoint;
+}
+
+Result Context::run(const Module& module, Sink& out, Profile* profile)
+{
+    Result result;
+    auto begin = std::chrono::steady_clock::now();
+    try {
+        if (profile) execute<true>(module, out, profile, result);
+        else execute<false>(module, out, nullptr, result);
+    } catch (const ExecutionLimit& e) {
+        result.status = Result::Terminated;
+        result.error = e.what();
+    } catch (const std::exception& e) {
+        result.status = Result::Failed;
+        result.error = e.what();
+    }
+    std::chrono::duration<double> wall = std::chrono::steady_clock::now() - begin;
+    result.wallSeconds = wall.count();
+    return result;
+}
+
+// Runs verified code from the start of main. Operands are not checked here: the verifier
+// has shown they are in range. The Profiling instance also counts opcodes and charges the
+// clock to the current region and call path whenever execution moves to another; the other
+// instance compiles to the plain dispatch loop.
+//
+// The instruction and time limits are only checked on backward jumps and calls, which every
+// loop and recursion passes through, and only once the instruction count reaches the next
+// checkpoint, so the common case costs a comparison. The heap limit is checked by "new" and
+// by a call deeper than any before it in the run, which needs a frame more; such a call also
+// checks the depth limit.
+//
+// Frames and objects left by earlier runs are reused: a call or "new" past the ones in use
+// takes the next entry and only allocates when its vector is too small.
+template <bool Profiling>
+void Context::execute(const Module& module, Sink& out, Profile* profile, Result& result)
+{
+    const Op* code = module.code.data();
+    const std::vector<Method>& methods = module.methods;
+    long long executed = 0;
+    size_t heapBytes = 0;
+
+    // Operand stack. A call leaves nothing of its caller's below the callee's operands, so
+    // it never holds more than the deepest method needs.
+    if (stack.size() < module.maxStack) stack.resize(module.maxStack);
+    int* sp = stack.data();                     // next free entry
+    size_t depth = 0;                           // innermost frame
+    size_t deepest = 0;                         // deepest frame of this run
+    size_t objects = 0;                         // objects allocated by this run
+    if (frames.empty()) frames.emplace_back();
+    frames[0].slots.assign(methods[0].slots, 0);
+    frames[0].self = nullptr;
+    frames[0].path = 0;
+    int* locals = frames[0].slots.data();
+    int* self = nullptr;
+    size_t currentRegion = module.regionOf[methods[0].entry];
+    size_t currentPath = 0;
+    unsigned long long since = Profiling ? ticks() : 0;
+    // Charges the clock since the last switch to the current region and path.
+    auto charge = [&]() {
+        unsigned long long now = ticks();
+        profile->regionCycles[currentRegion] += now - since;
+        profile->pathCycles[{currentPath, module.regions[currentRegion].line}] += now - since;
+        since = now;
+    };
+
+    auto begin = std::chrono::steady_clock::now();
+    long long checkpoint = 0;
+
+    size_t pc = methods[0].entry;
+    auto jump = [&](int target) {
+        if ((size_t)target < pc && executed >= checkpoint) checkpoint = nextCheckpoint(limits, executed, begin);
+        pc = target;
+    };
+    try
+    {
+        checkpoint = nextCheckpoint(limits, executed, begin);
+        for (;;)
+        {
+            if (Profiling)
+            {
+                size_t region = module.regionOf[pc];
+                if (region != currentRegion || frames[depth].path != currentPath)
+                {
+                    charge();
+                    currentRegion = region;
+                    currentPath = frames[depth].path;
+                }
+                size_t block = module.blockOf[pc];
+                if (pc == 0 || module.blockOf[pc - 1] != block)
+                    profile->blockEntries[block]++;
+                profile->regionInstructions[region]++;
+                profile->opcodeCounts[code[pc].code]++;
+            }
+            const Op& op = code[pc++];
+            executed++;
+            switch (op.code)
+            {
+                case ICONST: *sp++ = op.arg; break;
+                case ILOAD: *sp++ = locals[op.arg]; break;
+                case ISTORE: locals[op.arg] = *--sp; break;
+                case GETFIELD: *sp++ = self[op.arg]; break;
+                case PUTFIELD: self[op.arg] = *--sp; break;
+                case NEW:
+                    heapBytes += sizeof(std::vector<int>) + op.arg * sizeof(int);
+                    if (limits.maxHeap && heapBytes > limits.maxHeap)
+                        throw ExecutionLimit("heap limit of " + std::to_string(limits.maxHeap) + " bytes reached");
+                    if (objects == heap.size()) heap.emplace_back();
+                    heap[objects++].assign(op.arg, 0);
+                    *sp++ = (int)objects;
+                    break;
+                case INVOKE:
+                {
+                    // Pops the receiver and the arguments into a fresh frame and enters the callee.
+                    // The receiver is checked here once, so its fields need no checks.
+                    const Method& callee = methods[op.arg];
+                    if (executed >= checkpoint) checkpoint = nextCheckpoint(limits, executed, begin);
+                    sp -= callee.params + 1;
+                    int reference = sp[0];
+                    if (reference <= 0 || (size_t)reference > objects)
+                        throw std::runtime_error("call of " + callee.name + " on a null reference");
+                    if (heap[reference - 1].size() < callee.fields)
+                        throw std::runtime_error("call of " + callee.name + " on an object without its fields");
+                    if (depth == deepest)
+                    {
+                        deepest++;
+                        heapBytes += sizeof(Frame) + callee.slots * sizeof(int);
+                        if (limits.maxHeap && heapBytes > limits.maxHeap)
+                            throw ExecutionLimit("heap limit of " + std::to_string(limits.maxHeap) + " bytes reached");
+                        if (limits.maxDepth && deepest > limits.maxDepth)
+                            throw ExecutionLimit("call depth limit of " + std::to_string(limits.maxDepth) + " reached");
+                    }
+                    if (depth + 1 == frames.size()) frames.emplace_back();
+                    Frame& frame = frames[++depth];
+                    frame.slots.assign(callee.slots, 0);
+                    std::copy(sp, sp + callee.params + 1, frame.slots.begin());
+                    frame.self = heap[reference - 1].data();
+                    frame.returnPc = pc;
+                    frame.path = 0;
+                    if (Profiling)
+                    {
+                        int line = module.regions[module.regionOf[pc - 1]].line;
+                        std::tuple<size_t, size_t, int> call(frames[depth - 1].path, (size_t)op.arg, line);
+                        auto found = profile->callPathIndex.find(call);
+                        if (found == profile->callPathIndex.end())
+                        {
+                            found = profile->callPathIndex.insert({call, profile->callPaths.size()}).first;
+                            profile->callPaths.push_back({frames[depth - 1].path, (size_t)op.arg, line});
+                        }
+                        frame.path = found->second;
+                    }
+                    locals = frame.slots.data();
+                    self = frame.self;
+                    pc = callee.entry;
+                    break;
+                }
+                case IRETURN:
+                    // The return value stays on the stack for the caller.
+                    pc = frames[depth--].returnPc;
+                    locals = frames[depth].slots.data();
+                    self = frames[depth].self;
+                    break;
+                // Arithmetic wraps around, as the optimiser assumes: it is done on unsigned
+                // values, where overflow is defined.
+                case IADD: sp--; sp[-1] = (int)((unsigned)sp[-1] + (unsigned)sp[0]); break;
+                case ISUB: sp--; sp[-1] = (int)((unsigned)sp[-1] - (unsigned)sp[0]); break;
+                case IMUL: sp--; sp[-1] = (int)((unsigned)sp[-1] * (unsigned)sp[0]); break;
+                case IDIV:
+                    // The only operation whose operands the verifier cannot vouch for.
+                    sp--;
+                    if (sp[0] == 0) throw std::runtime_error("division by zero");
+                    if (sp[0] == -1 && sp[-1] == std::numeric_limits<int>::min()) throw std::runtime_error("division overflow");
+                    sp[-1] = sp[-1] / sp[0];
+                    break;
+                case IAND: sp--; sp[-1] = (sp[-1] && sp[0]) ? 1 : 0; break;
+                case IOR: sp--; sp[-1] = (sp[-1] || sp[0]) ? 1 : 0; break;
+                case INOT: sp[-1] = !sp[-1]; break;
+                case IEQ: sp--; sp[-1] = (sp[-1] == sp[0]) ? 1 : 0; break;
+                case IGT: sp--; sp[-1] = (sp[-1] > sp[0]) ? 1 : 0; break;
+                case ILT: sp--; sp[-1] = (sp[-1] < sp[0]) ? 1 : 0; break;
+                case PRINT: out.print(*--sp); break;
+                // A jump to an earlier opcode closes a loop and checks the limits.
+                case GOTO: jump(op.arg); break;
+                case IFFALSE: if (!*--sp) jump(op.arg); break;
+                case IFTRUE: if (*--sp) jump(op.arg); break;
+                // Compare-and-branch: pops both operands and jumps when the comparison holds.
+                case IF_ICMPLT: sp -= 2; if (sp[0] < sp[1]) jump(op.arg); break;
+                case IF_ICMPGE: sp -= 2; if (sp[0] >= sp[1]) jump(op.arg); break;
+                case IF_ICMPGT: sp -= 2; if (sp[0] > sp[1]) jump(op.arg); break;
+                case IF_ICMPLE: sp -= 2; if (sp[0] <= sp[1]) jump(op.arg); break;
+                case IF_ICMPEQ: sp -= 2; if (sp[0] == sp[1]) jump(op.arg); break;
+                case IF_ICMPNE: sp -= 2; if (sp[0] != sp[1]) jump(op.arg); break;
+                case STOP:
+                    if (Profiling) charge();
+                    result.instructions = executed;
+                    result.heapBytes = heapBytes;
+                    return;
+            }
+        }
+    }
+    catch (...)
+    {
+        // The counters still say how far a failed or terminated run got.
+        result.instructions = executed;
+        result.heapBytes = heapBytes;
+        throw;
+    }
+}
+
+void printProfile(const Module& module, const Profile& profile, std::ostream& out)
+{
+    const std::vector<Method>& methods = module.methods;
+    const std::vector<Block>& blocks = module.blocks;
+    const std::vector<Region>& regions = module.regions;
+    std::vector<long long> blockInstructions(blocks.size());
+    std::vector<unsigned long long> blockCycles(blocks.size());
+    for (size_t r = 0; r < regions.size(); r++)
+    {
+        blockInstructions[regions[r].block] += profile.regionInstructions[r];
+        blockCycles[regions[r].block] += profile.regionCycles[r];
+    }
+
+    std::vector<std::string> names(STOP + 1);
+    for (const auto& entry : opcodes)
+        names[entry.second] = entry.first;
+    const long long* counts = profile.opcodeCounts;
+    long long total = 1;
+    for (int op = 0; op <= STOP; op++) total += counts[op];
+    out << "profile: opcode executions\n";
+    std::vector<int> order;
+    for (int op = 0; op <= STOP; op++)
+        if (counts[op]) order.push_back(op);
+    std::sort(order.begin(), order.end(), [&](int a, int b) { return counts[a] > counts[b]; });
+    out << std::fixed << std::setprecision(1);
+    for (int op : order)
+        out << "  " << std::left << std::setw(10) << names[op] << std::right << std::setw(14) << counts[op]
+            << std::setw(7) << 100.0 * counts[op] / total << "%\n";
+
+    std::vector<unsigned long long> methodCycles(methods.size());
+    std::vector<long long> methodInstructions(methods.size());
+    unsigned long long allCycles = 1;
+    for (size_t b = 0; b < blocks.size(); b++)
+    {
+        methodCycles[blocks[b].method] += blockCycles[b];
+        methodInstructions[blocks[b].method] += blockInstructions[b];
+        allCycles += blockCycles[b];
+    }
+    std::vector<size_t> byCycles(methods.size());
+    for (size_t m = 0; m < methods.size(); m++) byCycles[m] = m;
+    std::sort(byCycles.begin(), byCycles.end(), [&](size_t a, size_t b) { return methodCycles[a] > methodCycles[b]; });
+    for (size_t m : byCycles)
+    {
+        if (!methodInstructions[m]) continue;
+        out << "profile: method " << methods[m].name << " instructions=" << methodInstructions[m]
+            << " cycles=" << methodCycles[m] << " (" << 100.0 * methodCycles[m] / allCycles << "%)\n";
+        std::vector<size_t> ran;
+        for (size_t b = 0; b < blocks.size(); b++)
+            if (blocks[b].method == m && blockInstructions[b]) ran.push_back(b);
+        std::sort(ran.begin(), ran.end(), [&](size_t a, size_t b) { return blockCycles[a] > blockCycles[b]; });
+        for (size_t b : ran)
+            out << "  " << std::left << std::setw(12) << blocks[b].label << std::right << " entries=" << profile.blockEntries[b]
+                << " instructions=" << blockInstructions[b] << " cycles=" << blockCycles[b]
+                << " (" << 100.0 * blockCycles[b] / allCycles << "%)\n";
+    }
+
+    // (method, line) -> instructions and cycles of its regions
+    std::map<std::pair<size_t, int>, std::pair<long long, unsigned long long>> lines;
+    for (size_t r = 0; r < regions.size(); r++)
+    {
+        if (!profile.regionInstructions[r]) continue;
+        auto& line = lines[{blocks[regions[r].block].method, regions[r].line}];
+        line.first += profile.regionInstructions[r];
+        line.second += profile.regionCycles[r];
+    }
+    std::vector<std::pair<std::pair<size_t, int>, std::pair<long long, unsigned long long>>> ranLines(lines.begin(), lines.end());
+    std::sort(ranLines.begin(), ranLines.end(), [](const decltype(ranLines)::value_type& a, const decltype(ranLines)::value_type& b) {
+        return a.second.second > b.second.second;
+    });
+    out << "profile: source lines\n";
+    for (const auto& entry : ranLines)
+    {
+        std::string where = methods[entry.first.first].name + ":" + (entry.first.second ? std::to_string(entry.first.second) : "?");
+        out << "  " << std::left << std::setw(20) << where << std::right << " instructions=" << entry.second.first
+            << " cycles=" << entry.second.second << " (" << 100.0 * entry.second.second / allCycles << "%)\n";
+    }
+}
+
+void writeFolded(const Module& module, const Profile& profile, std::ostream& out)
+{
+    const std::vector<Method>& methods = module.methods;
+    const std::vector<Profile::CallPath>& callPaths = profile.callPaths;
+    for (const auto& entry : profile.pathCycles)
+    {
+        if (!entry.second) continue;
+        std::string stack = methods[callPaths[entry.first.first].method].name + ":" + std::to_string(entry.first.second);
+        for (size_t path = entry.first.first; path != 0; path = callPaths[path].parent)
+        {
+            const Profile::CallPath& call = callPaths[path];
+            stack = methods[callPaths[call.parent].method].name + ":" + std::to_string(call.line) + ";" + stack;
+        }
+        out << stack << ' ' << entry.second << '\n';
+    }
+}
+
+}
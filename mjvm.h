@@ -0,0 +1,185 @@
+// libmjvm: the miniJava bytecode VM as a library.
+//
+// A Module is a .class file decoded and verified once. Running it never modifies it, so one
+// Module can be shared by any number of Contexts, on any threads. A Context holds what a run
+// needs - operand stack, frames and heap - and keeps that memory from one run to the next,
+// so a process can run many short programs without allocating per run. What a program prints
+// goes to a Sink supplied by the caller.
+//
+//     std::shared_ptr<const mjvm::Module> module = mjvm::loadFile("output.class");
+//     mjvm::Context context;
+//     mjvm::StreamSink out(std::cout);
+//     mjvm::Result result = context.run(*module, out);
+#ifndef MJVM_H
+#define MJVM_H
+
+#include <map>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace mjvm
+{
+
+// Bytecode is decoded at load into an array of opcodes with numeric operands, checked by the
+// verifier and then run without further checks. Labels and comments disappear and jumps hold
+// the index of their target. The opcodes up to INVOKE take a number.
+enum Opcode
+{
+    ICONST, ILOAD, ISTORE, GETFIELD, PUTFIELD, NEW, INVOKE, IRETURN,
+    IADD, ISUB, IMUL, IDIV, IAND, IOR, INOT, IEQ, IGT, ILT, PRINT,
+    GOTO, IFFALSE, IFTRUE, IF_ICMPLT, IF_ICMPGE, IF_ICMPGT, IF_ICMPLE, IF_ICMPEQ, IF_ICMPNE,
+    STOP
+};
+
+struct Op
+{
+    Opcode code;
+    int arg;        // constant, slot, field, field count, method or jump target
+};
+
+// A method as declared by its ".method <name> slots <N> params <P> stack <D>" header.
+// Methods are numbered in the order of their headers, main first; "invoke K" calls method K.
+struct Method
+{
+    std::string name;
+    size_t entry;   // index of its first opcode
+    size_t end;     // index after its last opcode
+    size_t slots;   // frame size
+    size_t params;  // parameters, passed in the slots after the receiver's
+    size_t stack;   // greatest operand stack depth
+    size_t fields;  // fields of 'this' it uses, counted by the verifier
+};
+
+// A "label block_N" and its code, or the code of a method ahead of its first label.
+struct Block
+{
+    std::string label;
+    size_t method;
+};
+
+// The line table: a ".line N" directive maps the opcodes after it, up to the next one, to
+// line N of the miniJava source. A region is a stretch of one block on one line, the unit
+// profiles charge cycles to; line 0 is code no statement produced.
+struct Region
+{
+    size_t block;
+    int line;
+};
+
+struct Module
+{
+    std::vector<Op> code;
+    std::vector<size_t> codeLines;  // line of the .class file each opcode came from, from 1
+    std::vector<Method> methods;
+    std::vector<Block> blocks;
+    std::vector<size_t> blockOf;    // block each opcode belongs to
+    std::vector<Region> regions;
+    std::vector<size_t> regionOf;   // region each opcode belongs to
+    size_t maxStack = 0;            // greatest operand stack depth of any method
+};
+
+// Decode and verify the lines of a .class file. Both throw std::runtime_error, with the
+// offending line of the file where there is one.
+std::shared_ptr<const Module> load(const std::vector<std::string>& lines);
+std::shared_ptr<const Module> loadFile(const std::string& fileName);
+
+// Receives what a program prints.
+struct Sink
+{
+    virtual ~Sink() {}
+    virtual void print(int value) = 0;
+};
+
+// Prints each value on a line of its own.
+struct StreamSink : Sink
+{
+    explicit StreamSink(std::ostream& out) : out(out) {}
+    void print(int value) override { out << value << '\n'; }
+    std::ostream& out;
+};
+
+// Caps on a run, for programs that cannot be trusted to end.
+struct Limits
+{
+    long long maxInstructions = 0;  // 0: no cap
+    double timeout = 0;             // seconds of wall time, 0: no cap
+    size_t maxHeap = 0;             // bytes, 0: no cap
+    size_t maxDepth = 0;            // nested calls, 0: no cap
+};
+
+struct Result
+{
+    enum Status { Finished, Failed, Terminated };
+    Status status = Finished;       // Failed: a runtime error; Terminated: a limit was reached
+    std::string error;              // why it failed or was terminated
+    long long instructions = 0;
+    size_t heapBytes = 0;           // fields allocated by "new" and each object's bookkeeping, and the frames of the deepest call
+    double wallSeconds = 0;
+};
+
+// What a profiled run measures. Cycles are the time-stamp counter on x86, nanoseconds
+// elsewhere, and are charged to the region running, so time in a callee is the callee's.
+struct Profile
+{
+    // A call path: main is path 0 and each other path is a call of 'method' made on 'line'
+    // of its parent path.
+    struct CallPath
+    {
+        size_t parent;
+        size_t method;
+        int line;
+    };
+
+    explicit Profile(const Module& module);
+    long long opcodeCounts[STOP + 1] = {};
+    std::vector<long long> blockEntries;
+    std::vector<long long> regionInstructions;
+    std::vector<unsigned long long> regionCycles;
+    std::vector<CallPath> callPaths;
+    std::map<std::tuple<size_t, size_t, int>, size_t> callPathIndex;
+    std::map<std::pair<size_t, int>, unsigned long long> pathCycles;   // (path, line) -> cycles
+};
+
+// Prints executions per opcode, then every method that ran with its blocks, then the source
+// lines that ran, each ordered by the cycles spent in it.
+void printProfile(const Module& module, const Profile& profile, std::ostream& out);
+
+// Writes the cycles of each call path and line in the folded format flame graph tools read:
+// "main:4;F.fib:14;F.fib:12 <cycles>", each frame naming a method and the line it was on.
+void writeFolded(const Module& module, const Profile& profile, std::ostream& out);
+
+// Runs modules, one at a time. Its stack, frames and heap are reused by the next run.
+class Context
+{
+public:
+    Limits limits;
+
+    // Runs 'module' from the start of main, passing what it prints to 'out', and counting
+    // into 'profile' when there is one.
+    Result run(const Module& module, Sink& out, Profile* profile = nullptr);
+
+private:
+    // The activation of a method: its variables, the fields of the object it runs on and
+    // where the caller continues.
+    struct Frame
+    {
+        std::vector<int> slots;
+        int* self;
+        size_t returnPc;
+        size_t path;    // call path, when profiling
+    };
+
+    template <bool Profiling>
+    void execute(const Module& module, Sink& out, Profile* profile, Result& result);
+
+    std::vector<int> stack;
+    std::vector<Frame> frames;              // frames[0 .. depth] are live, innermost last
+    std::vector<std::vector<int>> heap;     // heap[0 .. objects) are live; reference r is heap[r - 1], 0 is null
+};
+
+}
+
+#endif
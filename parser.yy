@@ -7,7 +7,16 @@
 %code requires{
   #include <string>
   #include "Node.h"
-  #define USE_LEX_ONLY false
+
+  // Told about each class and method as soon as it is reduced, for --single-pass. What
+  // method() and mainClass() return stays in the tree in place of the node they were given.
+  struct ParseListener {
+    virtual ~ParseListener() {}
+    virtual void beginClass(Node* identifier) = 0;
+    virtual Node* method(Node* methodDeclaration) = 0;
+    virtual Node* mainClass(Node* mainClass) = 0;
+  };
+  extern ParseListener* parseListener;
 }
 
 %code{
@@ -15,14 +24,15 @@
   YY_DECL;
   
   Node* root;
+  ParseListener* parseListener = nullptr;
   extern int yylineno;
 }
 
-%token <std::string> TYPE_INT TYPE_FLOAT TYPE_CHAR TYPE_BOOL TYPE_STRING TYPE_VOID
-%token <std::string> PUBLIC IF ELSE WHILE FOR RETURN TRUE FALSE THIS NEW MAIN STATIC CLASS PRINT_METHOD
-%token <std::string> IS_EQUAL ASSIGNOP PLUSOP MINUSOP MULTOP AND OR NOT
-%token <std::string> LPAREN RPAREN LBRACE RBRACE LBRACKET RBRACKET SEMICOLON COMMA GT LT DOT LENGTH
-%token <std::string> IDENTIFIER INT
+%token TYPE_INT TYPE_FLOAT TYPE_CHAR TYPE_BOOL TYPE_STRING TYPE_VOID
+%token PUBLIC IF ELSE WHILE FOR RETURN TRUE FALSE THIS NEW MAIN STATIC CLASS PRINT_METHOD
+%token IS_EQUAL ASSIGNOP PLUSOP MINUSOP MULTOP AND OR NOT
+%token LPAREN RPAREN LBRACE RBRACE LBRACKET RBRACKET SEMICOLON COMMA GT LT DOT LENGTH
+%token <const std::string*> IDENTIFIER INT  /* points into the lexer's interned spellings */
 
 %token END 0 "end of file"
 
@@ -40,7 +50,7 @@ root: goal {root = $1;};
 
 goal: mainClass classDeclarations END {$$ = new Node("goal", "", yylineno); $$->children.push_back($1); $$->children.push_back($2);};
 
-mainClass: PUBLIC CLASS identifier LBRACE PUBLIC STATIC TYPE_VOID MAIN LPAREN TYPE_STRING LBRACKET RBRACKET identifier RPAREN LBRACE statement statements RBRACE RBRACE {$$ = new Node("mainClass", "", yylineno); $$->children.push_back($3); $$->children.push_back($13); $$->children.push_back($16); $$->children.push_back($17);};
+mainClass: PUBLIC CLASS identifier LBRACE PUBLIC STATIC TYPE_VOID MAIN LPAREN TYPE_STRING LBRACKET RBRACKET identifier RPAREN LBRACE statement statements RBRACE RBRACE {$$ = new Node("mainClass", "", yylineno); $$->children.push_back($3); $$->children.push_back($13); $$->children.push_back($16); $$->children.push_back($17); if (parseListener) $$ = parseListener->mainClass($$);};
 
 
 statement: LBRACE statements RBRACE {$$ = new Node("block", "", yylineno); $$->children.push_back($2);}
@@ -71,7 +81,7 @@ expression: expression AND expression { $$ = new Node("andExpression", "", yylin
           | expression LBRACKET expression RBRACKET { $$ = new Node("AllocateIdentifier", "", yylineno); $$->children.push_back($1); $$->children.push_back($3); }
           | expression DOT LENGTH { $$ = new Node("lengthMethod", "", yylineno); $$->children.push_back($1); }
           | expression DOT identifier LPAREN argument_list RPAREN { $$ = new Node("methodCall", "", yylineno); $$->children.push_back($1); $$->children.push_back($3); $$->children.push_back($5);}
-          | INT { $$ = new Node("intLiteral", $1, yylineno); } // change $1 back to nothing
+          | INT { $$ = new Node("intLiteral", *$1, yylineno); } // change $1 back to nothing
           | TRUE { $$ = new Node("true", "1", yylineno); }
           | FALSE { $$ = new Node("false", "0", yylineno); }
           | identifier { $$ = $1; }
@@ -79,7 +89,7 @@ expression: expression AND expression { $$ = new Node("andExpression", "", yylin
           | NEW TYPE_INT LBRACKET expression RBRACKET { $$ = new Node("newInt", "", yylineno); $$->children.push_back($4); }
           | NEW identifier LPAREN RPAREN { $$ = new Node("newID", "", yylineno); $$->children.push_back($2); }
           | NOT expression { $$ = new Node("notExpression", "", yylineno); $$->children.push_back($2); }
-          | LPAREN expression RPAREN {$$ = new Node("ParenExpression", "", yylineno); $$ = $2;}
+          | LPAREN expression RPAREN { $$ = $2; }
           ;
 
 argument_list: %empty { $$ = new Node("noArguments", "", yylineno); }
@@ -90,15 +100,15 @@ non_empty_argument_list: expression {$$ = new Node("argument", "", yylineno); $$
                        | non_empty_argument_list COMMA expression {$$ = new Node("argumentList", "", yylineno); $$->children.push_back($1); $$->children.push_back($3); }
                        ;
 
-classDeclaration: CLASS identifier LBRACE varDeclarations methodDeclarations RBRACE {$$ = new Node("classDeclaration", "", yylineno); $$->children.push_back($2); $$->children.push_back($4); $$->children.push_back($5);};
+classDeclaration: CLASS identifier { if (parseListener) parseListener->beginClass($2); } LBRACE varDeclarations methodDeclarations RBRACE {$$ = new Node("classDeclaration", "", yylineno); $$->children.push_back($2); $$->children.push_back($5); $$->children.push_back($6);};
 
 classDeclarations: classDeclaration {$$ = new Node("classDeclarations", "", yylineno); $$->children.push_back($1);}
                  | classDeclarations classDeclaration {$$ = new Node("classDeclarations", "", yylineno); $$->children.push_back($1); $$->children.push_back($2);}
                  | %empty {$$ = new Node("emptyClassDeclarations", "", yylineno);}
                  ;
 
-varOrStatements: varDeclaration varOrStatements {$$ = $2; $$->children.push_back($1);}
-               | statement varOrStatements {$$ = $2; $$->children.push_back($1);}
+varOrStatements: varOrStatements varDeclaration {$$ = $1; $$->children.push_back($2);}
+               | varOrStatements statement {$$ = $1; $$->children.push_back($2);}
                | %empty {$$ = new Node("emptyVarOrStatement", "", yylineno);}
                ;
 
@@ -134,7 +144,7 @@ ParameterList:
 chooseParam: parameters { $$ = $1; }
            ;
 
-methodDeclaration: PUBLIC type identifier LPAREN chooseParam RPAREN LBRACE varOrStatements RETURN expression SEMICOLON RBRACE {$$ = new Node("methodDeclaration", "", yylineno); $$->children.push_back($2); $$->children.push_back($3); $$->children.push_back($5); $$->children.push_back($8); $$->children.push_back($10);};
+methodDeclaration: PUBLIC type identifier LPAREN chooseParam RPAREN LBRACE varOrStatements RETURN expression SEMICOLON RBRACE {$$ = new Node("methodDeclaration", "", yylineno); $$->children.push_back($2); $$->children.push_back($3); $$->children.push_back($5); $$->children.push_back($8); $$->children.push_back($10); if (parseListener) $$ = parseListener->method($$);};
 
 methodDeclarations: methodDeclarations methodDeclaration {$$ = new Node("methodDeclarations", "", yylineno); $$->children.push_back($1); $$->children.push_back($2);}
                   | %empty {$$ = new Node("emptyMethodDeclarations", "", yylineno);}
@@ -155,4 +165,4 @@ type: TYPE_INT LBRACKET RBRACKET { $$ = new Node("ArrayType", "", yylineno); }
   | identifier { $$ = $1; }
   ; 
 
-identifier: IDENTIFIER {$$ = new Node("Identifier", $1, yylineno);};
\ No newline at end of file
+identifier: IDENTIFIER {$$ = new Node("Identifier", *$1, yylineno);};
\ No newline at end of file
@@ -0,0 +1,74 @@
+// Frame slot allocation: variables of a method whose live ranges never overlap share a
+// slot, so a frame grows with the number of values live at once rather than with the
+// number of temps the method uses.
+
+// Gives every parameter, local and temp of a function a frame slot by linear scan over
+// live intervals, and returns the frame size. An interval runs from the first to the last
+// point, in the given block order, where the variable is assigned, read or live across a
+// block boundary. Methods keep 'this' in slot 0 and their parameters in the slots after
+// it, in order, so a caller knows where to put them. Fields live in the object.
+int IR::allocateSlots(Function* function, const std::vector<BasicBlock*> &order) {
+    computeLiveness(function);
+    function->slots.clear();
+
+    // Points are numbered so that an instruction reads its operands before it writes
+    // its result: an operand read for the last time can give its slot to the result.
+    struct Interval { std::string name; int start, end; };
+    std::vector<Interval> intervals;
+    std::unordered_map<std::string, size_t> byName;
+    auto extend = [&](const std::string &name, int point) {
+        if (function->isField(name)) return;
+        auto found = byName.find(name);
+        if (found == byName.end()) {
+            byName[name] = intervals.size();
+            intervals.push_back({name, point, point});
+            return;
+        }
+        Interval &interval = intervals[found->second];
+        interval.start = std::min(interval.start, point);
+        interval.end = std::max(interval.end, point);
+    };
+
+    size_t fixed = 0;
+    if (function->name != "main") { extend("this", 0); fixed++; }
+    for (const std::string &param : function->params) { extend(param, 0); fixed++; }
+    int point = 0;
+    for (BasicBlock* block : order) {
+        for (const std::string &name : block->liveIn) extend(name, point);
+        point += 2;
+        for (const Instruction &inst : block->instructions) {
+            for (const std::string &arg : inst.args) extend(arg, point);
+            if (!inst.dst.empty()) extend(inst.dst, point + 1);
+            point += 2;
+        }
+        for (const std::string &name : block->liveOut) extend(name, point);
+        point += 2;
+    }
+    // Field accesses read 'this' from slot 0 without naming it, so it is never given up.
+    if (function->name != "main") extend("this", point);
+
+    std::stable_sort(intervals.begin() + fixed, intervals.end(), [](const Interval &a, const Interval &b) {
+        return a.start < b.start;
+    });
+    typedef std::pair<int, int> EndAndSlot;
+    std::priority_queue<EndAndSlot, std::vector<EndAndSlot>, std::greater<EndAndSlot>> active;
+    std::priority_queue<int, std::vector<int>, std::greater<int>> free;
+    int slotCount = 0;
+    for (size_t i = 0; i < intervals.size(); i++) {
+        const Interval &interval = intervals[i];
+        while (!active.empty() && active.top().first < interval.start) {
+            free.push(active.top().second);
+            active.pop();
+        }
+        int slot;
+        if (i < fixed || free.empty()) {
+            slot = slotCount++;
+        } else {
+            slot = free.top();
+            free.pop();
+        }
+        function->slots[interval.name] = slot;
+        active.push({interval.end, slot});
+    }
+    return slotCount;
+}
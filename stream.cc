@@ -0,0 +1,187 @@
+// Single-pass compilation (--single-pass): each method is checked and lowered to IR as soon
+// as the parser reduces it, and its subtree is freed straight away, so the AST of the whole
+// program never exists at once.
+//
+// Calls may name methods declared further down and expressions may use fields of classes
+// that come later, so the declarations are collected first, by a pre-scan that parses the
+// source once and keeps only class, field, method, parameter and variable declarations.
+// The source is then parsed again and each method body is translated as it is reduced.
+//
+// The pre-scan runs the full parser, bodies included, so the mode costs a second parse; a
+// scan that skipped method bodies by counting braces would be cheaper but would have to
+// repeat the grammar's declaration rules. Memory is what this mode saves, not time.
+
+extern Node* root;
+extern FILE* yyin;
+extern int yylineno;
+extern int lexical_errors;
+extern void yyrestart(FILE *input);
+
+// Pass 1: prunes every method down to its signature and variable declarations as it is
+// reduced, leaving a skeleton of the program.
+class DeclarationScan : public ParseListener {
+public:
+    void beginClass(Node*) override {}
+
+    Node* method(Node* methodDeclaration) override {
+        // [type, identifier, parameters, varOrStatements, return expression]
+        auto body = std::next(methodDeclaration->children.begin(), 3);
+        (*body)->children.remove_if([](Node* child) {
+            if (child->type == "varDeclaration") return false;
+            deleteTree(child);
+            return true;
+        });
+        deleteTree(methodDeclaration->children.back());
+        methodDeclaration->children.pop_back();
+        return methodDeclaration;
+    }
+
+    Node* mainClass(Node* mainClass) override {
+        // [class identifier, argument identifier, statement, statements]
+        while (mainClass->children.size() > 2) {
+            deleteTree(mainClass->children.back());
+            mainClass->children.pop_back();
+        }
+        return mainClass;
+    }
+};
+
+// Pass 2: runs semantic analysis and IR generation on each method and on the main class
+// when they are reduced and frees them, leaving null children in the tree.
+class MethodStream : public ParseListener {
+public:
+    MethodStream(SymbolTable &symbolTable, IR &ir, const std::vector<Node*> &classes)
+        : symbolTable(symbolTable), ir(ir), classes(classes) {}
+
+    // Checks the fields of the class from its skeleton, so that they are reported in the
+    // same order as in a normal compile.
+    void beginClass(Node* identifier) override {
+        className = identifier->value;
+        whatClassWeAreInRn = className;
+        Node* skeleton = nextClass < classes.size() ? classes[nextClass++] : nullptr;
+        if (skeleton) {
+            symbolTable.enterScope(className);
+            performSemanticAnalysis(*std::next(skeleton->children.begin()), symbolTable);
+            symbolTable.exitScope();
+        }
+    }
+
+    Node* method(Node* methodDeclaration) override {
+        whatClassWeAreInRn = className;
+        symbolTable.enterScope(className);
+        performSemanticAnalysis(methodDeclaration, symbolTable);
+        symbolTable.exitScope();
+        if (!symbolTable.hasErrors()) {
+            ir.currentClass = className;
+            ir.genStmt(methodDeclaration);
+        }
+        deleteTree(methodDeclaration);
+        return nullptr;
+    }
+
+    Node* mainClass(Node* mainClass) override {
+        performSemanticAnalysis(mainClass, symbolTable);
+        if (!symbolTable.hasErrors())
+            ir.genStmt(mainClass);
+        deleteTree(mainClass);
+        return nullptr;
+    }
+
+private:
+    SymbolTable &symbolTable;
+    IR &ir;
+    const std::vector<Node*> &classes;  // Skeletons of the classes, in source order.
+    size_t nextClass = 0;
+    std::string className;
+};
+
+// Drives the two passes over the input yyin reads. A stream that cannot be rewound, such as
+// a pipe, is copied to a temporary file first.
+class SinglePassCompiler {
+public:
+    SinglePassCompiler(SymbolTable &symbolTable, IR &ir) : symbolTable(symbolTable), ir(ir) {}
+
+    ~SinglePassCompiler() {
+        deleteTree(skeleton);
+        if (copy) {
+            fclose(copy);
+            yyin = nullptr;
+        }
+    }
+
+    // Parses the input into the skeleton and collects its declarations into the symbol
+    // table and the class fields into the IR. Returns false on a syntax error.
+    bool prescan() {
+        FILE* input = yyin ? yyin : stdin;
+        if (fseek(input, 0, SEEK_CUR) != 0) {
+            copy = tmpfile();
+            char buffer[1 << 16];
+            for (size_t got; copy && (got = fread(buffer, 1, sizeof buffer, input)) > 0; )
+                fwrite(buffer, 1, got, copy);
+            if (!copy) return false;
+            rewind(copy);
+            input = copy;
+        }
+        start = ftell(input);
+        yyin = input;
+        yyrestart(yyin);
+
+        DeclarationScan scan;
+        if (!parseWith(scan)) return false;
+        skeleton = root;
+        traverseTree(skeleton, symbolTable);
+
+        // The classes, in source order; the main class comes first and has no fields.
+        std::vector<Node*> work;
+        if (skeleton) work.push_back(skeleton);
+        while (!work.empty()) {
+            Node* node = work.back();
+            work.pop_back();
+            if (node->type == "classDeclaration") {
+                classes.push_back(node);
+                continue;
+            }
+            for (auto it = node->children.rbegin(); it != node->children.rend(); ++it)
+                if (*it) work.push_back(*it);
+        }
+        for (Node* classNode : classes) {
+            ir.currentClass = classNode->children.front()->value;
+            ir.genStmt(*std::next(classNode->children.begin()));
+        }
+        return true;
+    }
+
+    // Parses the input again, translating each method as it is reduced.
+    bool translate() {
+        fseek(yyin, start, SEEK_SET);
+        yyrestart(yyin);
+        yylineno = 1;
+        lexical_errors = 0;
+        whatClassWeAreInRn = "";
+        ir.errorOccurred = false;
+
+        MethodStream stream(symbolTable, ir, classes);
+        bool parsed = parseWith(stream);
+        deleteTree(root);   // What is left: classes and declaration lists, without the methods.
+        root = nullptr;
+        if (ir.errorOccurred) std::cerr << "\n--- IR Generation Failed ---\n" << std::endl;
+        return parsed;
+    }
+
+private:
+    bool parseWith(ParseListener &listener) {
+        yy::parser parser;
+        root = nullptr;
+        parseListener = &listener;
+        bool parsed = !parser.parse();
+        parseListener = nullptr;
+        return parsed;
+    }
+
+    SymbolTable &symbolTable;
+    IR &ir;
+    Node* skeleton = nullptr;
+    std::vector<Node*> classes;
+    FILE* copy = nullptr;   // The input, when it had to be copied.
+    long start = 0;         // Where the program starts in the input.
+};
@@ -26,9 +26,10 @@ public:
     std::string type;               // Data type (e.g., "int", "boolean")
     std::vector<Symbol> parameters; // If it's a method, its parameter list
     int lineOfDeclaration;
+    int methodId = -1;              // If it's a method of a class, its number; main is 0
 
     
-    Symbol() : kind(SymbolKind::Variable), name(""), type("") {}
+    Symbol() : name(""), kind(SymbolKind::Variable), type("") {}
 
     
     Symbol(std::string name, SymbolKind kind, std::string type, std::vector<Symbol> parameters, int lineOfDeclaration)
@@ -55,6 +56,7 @@ public:
     std::vector<Scope> scopes;
     std::stack<size_t> currentScopeStack;
     std::vector<std::pair<std::string, int>> errors;  
+    int methodCount = 0;            // Methods numbered so far; main is method 0.
 
 public:
     
@@ -170,9 +172,22 @@ Symbol* lookupMethodInClassScope(const std::string& className, const std::string
 
 
 
-std::string evaluateExpressionType(Node* node, SymbolTable& symbolTable) {
-    if (!node) return "unknown";
+// Number of child expressions whose types are needed before the node itself can be typed.
+size_t typedOperandCount(Node* node) {
+    const std::string& type = node->type;
+    if (type == "addExpression" || type == "subExpression" || type == "multExpression" ||
+        type == "andExpression" || type == "orExpression" ||
+        type == "lessThan" || type == "greaterThan" || type == "isEqualExpression")
+        return node->children.size() < 2 ? 0 : 2;
+    if (type == "notExpression" || type == "ParenExpression")
+        return node->children.empty() ? 0 : 1;
+    if (type == "methodCall")
+        return node->children.size() < 2 ? 0 : 1;  // Only the receiver object is typed.
+    return 0;
+}
 
+// Types a node that has no operands to evaluate: literals, identifiers, "this", allocations and type names.
+std::string leafExpressionType(Node* node, SymbolTable& symbolTable) {
     // Handle literals
     if (node->type == "intLiteral") {
         return "IntType";
@@ -203,10 +218,6 @@ std::string evaluateExpressionType(Node* node, SymbolTable& symbolTable) {
 
     // If it's an identifier, look it up in the symbol table.
     if (node->type == "Identifier") {
-        cout << "Node type Here: " << node->type << endl;
-        cout << "Node Value Here: " << node->value << endl;
-        cout << "Node Lineno Here: " << node->lineno << endl;
-
         Symbol* sym = symbolTable.findSymbol(node->value);
 
         if (!sym) {
@@ -217,18 +228,32 @@ std::string evaluateExpressionType(Node* node, SymbolTable& symbolTable) {
         return sym->type;
     }
 
+    // Handle object creation for a class.
+    if (node->type == "newID") {
+        if (!node->children.empty())
+            return (*node->children.begin())->value;  // The class name becomes the type.
+        return "unknown";
+    }
+
+    // Handle array creation.
+    if (node->type == "newInt") {
+        return "ArrayType";
+    }
+
+    // If the node's type is already one of the known types, return it.
+    if (node->type == "IntType" || node->type == "boolean" || node->type == "floatType" ||
+        node->type == "charType" || node->type == "ArrayType")
+         return node->type;
+
+    return "unknown";
+}
+
+// Combines the already evaluated operand types of an expression node into its own type.
+std::string combineExpressionType(Node* node, const std::string* operandTypes, SymbolTable& symbolTable) {
     // Handle arithmetic expressions (add, sub, mult)
     if (node->type == "addExpression" || node->type == "subExpression" || node->type == "multExpression") {
-        if (node->children.size() < 2) return "unknown";
-        cout << " Test  1 " << endl;
-        auto it = node->children.begin();
-        std::string leftType = evaluateExpressionType(*it, symbolTable);
-        ++it;
-        std::string rightType = evaluateExpressionType(*it, symbolTable);
-        cout << rightType << " Test  2 " << endl;
-        cout << leftType << " Test  4LEFT " << endl;
-
-        
+        const std::string& leftType = operandTypes[0];
+        const std::string& rightType = operandTypes[1];
         if (leftType == "unknown" && rightType == "unknown")
             return "unknown";
         if (rightType == "IntType" || leftType == "IntType") {
@@ -241,11 +266,8 @@ std::string evaluateExpressionType(Node* node, SymbolTable& symbolTable) {
 
     // Handle logical expressions (and, or)
     if (node->type == "andExpression" || node->type == "orExpression") {
-        if (node->children.size() < 2) return "unknown";
-        auto it = node->children.begin();
-        std::string leftType = evaluateExpressionType(*it, symbolTable);
-        ++it;
-        std::string rightType = evaluateExpressionType(*it, symbolTable);
+        const std::string& leftType = operandTypes[0];
+        const std::string& rightType = operandTypes[1];
         if (leftType == "unknown" || rightType == "unknown")
             return "unknown";
         if (leftType == "boolean" && rightType == "boolean") {
@@ -258,11 +280,8 @@ std::string evaluateExpressionType(Node* node, SymbolTable& symbolTable) {
 
     // Handle relational expressions (lessThan, greaterThan, isEqualExpression)
     if (node->type == "lessThan" || node->type == "greaterThan" || node->type == "isEqualExpression") {
-        if (node->children.size() < 2) return "unknown";
-        auto it = node->children.begin();
-        std::string leftType = evaluateExpressionType(*it, symbolTable);
-        ++it;
-        std::string rightType = evaluateExpressionType(*it, symbolTable);
+        const std::string& leftType = operandTypes[0];
+        const std::string& rightType = operandTypes[1];
         if (leftType == "unknown" || rightType == "unknown")
             return "unknown";
         if (leftType == "IntType" && rightType == "IntType") {
@@ -275,9 +294,7 @@ std::string evaluateExpressionType(Node* node, SymbolTable& symbolTable) {
 
     // Handle not expression
     if (node->type == "notExpression") {
-        if (node->children.empty()) return "unknown";
-        std::string innerType = evaluateExpressionType(*node->children.begin(), symbolTable);
-        if (innerType == "boolean") {
+        if (operandTypes[0] == "boolean") {
             return "boolean";
         }
         std::cerr << "@error at line " << node->lineno << ": 'not' operator requires boolean operand" << std::endl;
@@ -285,23 +302,18 @@ std::string evaluateExpressionType(Node* node, SymbolTable& symbolTable) {
         return "unknown";
     }
 
-    // Parenthesized expression: just evaluate the inner expression.
+    // Parenthesized expression: just the type of the inner expression.
     if (node->type == "ParenExpression") {
-        if (node->children.empty()) return "unknown";
-        return evaluateExpressionType(*node->children.begin(), symbolTable);
+        return operandTypes[0];
     }
 
     // Handle method calls.
     if (node->type == "methodCall") {
-        // Expect at least two children: object and method identifier.
-        if (node->children.size() < 2) return "unknown";
-        auto it = node->children.begin();
-        Node* objectNode = *it;
-        std::string objectType = evaluateExpressionType(objectNode, symbolTable);
-        cout << "objectType " << objectType << endl;
-        ++it;
-        Node* methodIdNode = *it;
-        
+        const std::string& objectType = operandTypes[0];
+        Node* methodIdNode = *std::next(node->children.begin());
+        // Recorded for code generation; it only runs once analysis found no errors.
+        node->resolved = objectType + "." + methodIdNode->value;
+
         // Instead of searching in the class symbol's parameters vector,
         // use lookupMethodInClassScope to search the actual class scope.
         Symbol* methodSymbol = lookupMethodInClassScope(objectType, methodIdNode->value, symbolTable);
@@ -311,29 +323,44 @@ std::string evaluateExpressionType(Node* node, SymbolTable& symbolTable) {
             symbolTable.addError("Undeclared method", methodIdNode->lineno);
             return "unknown";                                  // cout to cerr valid invalid
         }
-        cout << "methodSymbol->type; " << methodSymbol->type << endl;
+        node->methodId = methodSymbol->methodId;
         return methodSymbol->type;
     }
-    
-    
-    // Handle object creation for a class.
-    if (node->type == "newID") {
-        if (!node->children.empty())
-            return (*node->children.begin())->value;  // The class name becomes the type.
-        return "unknown";
-    }
 
-    // Handle array creation.
-    if (node->type == "newInt") {
-        return "ArrayType";
-    }
+    return "unknown";
+}
 
-    // If the node's type is already one of the known types, return it.
-    if (node->type == "IntType" || node->type == "boolean" || node->type == "floatType" ||
-        node->type == "charType" || node->type == "ArrayType")
-         return node->type;
+// Types an expression bottom-up. The walk keeps its own stacks instead of recursing,
+// so arbitrarily long operator chains such as "a + b + c + ..." cannot overflow the call stack.
+std::string evaluateExpressionType(Node* node, SymbolTable& symbolTable) {
+    if (!node) return "unknown";
 
-    return "unknown";
+    std::vector<std::pair<Node*, bool>> work;  // second: operands already evaluated
+    std::vector<std::string> types;            // types of the evaluated operands, innermost last
+    work.push_back({node, false});
+
+    while (!work.empty()) {
+        Node* current = work.back().first;
+        bool operandsDone = work.back().second;
+        work.pop_back();
+
+        size_t operands = typedOperandCount(current);
+        if (operands == 0) {
+            types.push_back(leafExpressionType(current, symbolTable));
+        } else if (!operandsDone) {
+            work.push_back({current, true});
+            auto it = current->children.begin();
+            Node* first = *it;
+            if (operands == 2)
+                work.push_back({*++it, false});
+            work.push_back({first, false});
+        } else {
+            std::string result = combineExpressionType(current, &types[types.size() - operands], symbolTable);
+            types.resize(types.size() - operands);
+            types.push_back(result);
+        }
+    }
+    return types.back();
 }
 
 
@@ -390,9 +417,15 @@ void SymbolTable::enterScope(std::string scopeName) {
         }
     }
     
-    // Reserve extra capacity to avoid reallocation.
+    // Reserve extra capacity to avoid reallocation. Growing the vector moves every
+    // scope, so the parent links have to be re-pointed into the new storage.
     if (scopes.capacity() - scopes.size() < 1) {
+        std::vector<long> parentIndexes;
+        for (const Scope& scope : scopes)
+            parentIndexes.push_back(scope.parent ? scope.parent - &scopes[0] : -1);
         scopes.reserve(scopes.size() * 2 + 100);
+        for (size_t i = 0; i < scopes.size(); ++i)
+            scopes[i].parent = parentIndexes[i] < 0 ? nullptr : &scopes[parentIndexes[i]];
     }
     
     // Create a new scope.
@@ -445,8 +478,8 @@ void SymbolTable::printAllScopes() {
             std::cout << "  No symbols in this scope." << std::endl;
         } else {
             std::cout << "  Symbols:" << std::endl;
-            for (const auto& [name, symbol] : scope.symbols) {
-                std::cout << "    - Name: " << name << ", TypePrintScopes: " << symbol.type;
+            for (const auto& entry : scope.symbols) {
+                std::cout << "    - Name: " << entry.first << ", TypePrintScopes: " << entry.second.type;
                        //   << ", Kind: " << static_cast<int>(symbol.kind) << std::endl;
             }
         }
@@ -476,12 +509,11 @@ Symbol* SymbolTable::findSymbol(std::string name) { //GOOD ONE
 
     // Start from the current scope and move up
     size_t currentScopeIndex = currentScopeStack.top();
-    Scope& currentScope = scopes[currentScopeIndex];
     // std::cout << "[DEBUG] Starting search for symbol: '" << name << "' from scope index: " 
            //   << currentScopeIndex << " (Scope: " << currentScope.scopeName << ") at address: " 
            //   << &currentScope << std::endl;
               // std::cout << " Scope Indexes Here: ";
-              printCurrentScopeStack();
+              // printCurrentScopeStack();
               // std::cout << endl;
 
     while (true) {
@@ -492,13 +524,13 @@ Symbol* SymbolTable::findSymbol(std::string name) { //GOOD ONE
 
         // Print all symbols in the current scope with details
         // std::cout << "[DEBUG] Symbols in scope '" << currentScope.scopeName << "':" << std::endl;
-        for (const auto& entry : currentScope.symbols) {
+        // for (const auto& entry : currentScope.symbols) {
             // std::cout << "    Key: " << entry.first 
                              // << ", Name: " << entry.second.name 
                              // << ", Type: " << entry.second.type 
                              // << ", Kind: " << static_cast<int>(entry.second.kind)
                              // << std::endl;
-        }
+        // }
 
         // Check if the symbol exists in the current scope
         auto it = currentScope.symbols.find(name);
@@ -594,135 +626,124 @@ void printSymbolTable(const SymbolTable& symbolTable) {
     symbolTable.printTable();
 }
 
-void traverseTree(Node* node, SymbolTable& symbolTable) {
-    if (!node) return;
-    
-    //// std::cout << "Processing node type: " << node->type << " with value: " << node->value << std::endl;
-
-    if (node->type == "mainClass") {
-        auto it = node->children.begin();
-        Node* classNode = *it; // first child: class identifier
-        std::string className = classNode->value;
-        if (!symbolTable.addSymbolST(className, SymbolKind::Class, "ClassType", std::vector<Symbol>(), classNode->lineno)) {
-            std::cerr << "@error at line " << classNode->lineno
-                      << ". Already Declared Class: '" << className << "'" << std::endl;
-            symbolTable.addError("Already Declared Class", classNode->lineno);
-                    
+// Builds the symbol table. The AST is walked with an explicit work list instead of
+// recursion so that deeply nested programs cannot overflow the call stack.
+void traverseTree(Node* ast, SymbolTable& symbolTable) {
+    std::vector<Node*> work;      // Nodes still to visit, next one last; nullptr exits a scope.
+    std::vector<Node*> children;  // Children of the current node to visit next, in source order.
+    if (ast) work.push_back(ast);
+
+    while (!work.empty()) {
+        Node* node = work.back();
+        work.pop_back();
+        if (!node) {
+            symbolTable.exitScope();
+            continue;
         }
-        symbolTable.enterScope(className);
-        for (++it; it != node->children.end(); ++it)
-            traverseTree(*it, symbolTable);
-        symbolTable.exitScope();
-    } else if (node->type == "assign"){
-
-    } else if (node->type == "classDeclaration") {
-        auto it = node->children.begin();
-        Node* classNode = *it; // first child: class identifier
-        std::string className = classNode->value;
-        if (!symbolTable.addSymbolST(className, SymbolKind::Class, "ClassType", std::vector<Symbol>(), classNode->lineno)) {
-            std::cerr << "@error at line " << classNode->lineno
-                      << ". Already Declared Class: '" << className << "'" << std::endl;
-            symbolTable.addError("Already Declared Class", classNode->lineno);
+        children.clear();
 
-        }
-        symbolTable.enterScope(className);
-        for (++it; it != node->children.end(); ++it)
-            traverseTree(*it, symbolTable);
-        symbolTable.exitScope();
-    } else if (node->type == "Method" || node->type == "methodDeclaration") {
-        auto it = node->children.begin();
-        Node* returnTypeNode = *it; // e.g., "IntType"
-        cout << returnTypeNode->type << " ABABA" << endl;
-        ++it;
-        Node* methodNameNode = *it; // Method name node.
-        std::string methodName = methodNameNode->value;
-        // std::cout << "[DEBUG TRAVERSE TREE] Found method declaration: '" << methodName 
-                             // << "' with return type: '" << returnTypeNode->type << "'" << std::endl;
-        
-        // Step 1: Add the method symbol to the enclosing class's scope.
-        if (!symbolTable.currentScopeStack.empty()) {
-            size_t classScopeIndex = symbolTable.currentScopeStack.top(); // Enclosing class scope.
-            string bombaCLATTTTTTTTTT = returnTypeNode->type;
-            if(returnTypeNode->type == "Identifier"){
-                bombaCLATTTTTTTTTT = returnTypeNode->value;
+        //// std::cout << "Processing node type: " << node->type << " with value: " << node->value << std::endl;
+
+        if (node->type == "mainClass") {
+            auto it = node->children.begin();
+            Node* classNode = *it; // first child: class identifier
+            std::string className = classNode->value;
+            if (!symbolTable.addSymbolST(className, SymbolKind::Class, "ClassType", std::vector<Symbol>(), classNode->lineno)) {
+                std::cerr << "@error at line " << classNode->lineno
+                          << ". Already Declared Class: '" << className << "'" << std::endl;
+                symbolTable.addError("Already Declared Class", classNode->lineno);
+                    
             }
-            if (!symbolTable.scopes[classScopeIndex].addSymbol(methodName, SymbolKind::Method, bombaCLATTTTTTTTTT, std::vector<Symbol>(), methodNameNode->lineno)) {
-                std::cerr << "@error at line " << methodNameNode->lineno 
-                          << ": Duplicate method declaration: '" << methodName << "'" << std::endl;
-                symbolTable.addError("Duplicate method declaration", methodNameNode->lineno);
+            symbolTable.enterScope(className);
+            for (++it; it != node->children.end(); ++it)
+                children.push_back(*it);
+            work.push_back(nullptr);  // Leave the scope after the children.
+        } else if (node->type == "assign"){
+
+        } else if (node->type == "classDeclaration") {
+            auto it = node->children.begin();
+            Node* classNode = *it; // first child: class identifier
+            std::string className = classNode->value;
+            if (!symbolTable.addSymbolST(className, SymbolKind::Class, "ClassType", std::vector<Symbol>(), classNode->lineno)) {
+                std::cerr << "@error at line " << classNode->lineno
+                          << ". Already Declared Class: '" << className << "'" << std::endl;
+                symbolTable.addError("Already Declared Class", classNode->lineno);
+
             }
-        }
+            symbolTable.enterScope(className);
+            for (++it; it != node->children.end(); ++it)
+                children.push_back(*it);
+            work.push_back(nullptr);  // Leave the scope after the children.
+        } else if (node->type == "Method" || node->type == "methodDeclaration") {
+            auto it = node->children.begin();
+            Node* returnTypeNode = *it; // e.g., "IntType"
+            // cout << returnTypeNode->type << " ABABA" << endl;
+            ++it;
+            Node* methodNameNode = *it; // Method name node.
+            std::string methodName = methodNameNode->value;
+            // std::cout << "[DEBUG TRAVERSE TREE] Found method declaration: '" << methodName 
+                                 // << "' with return type: '" << returnTypeNode->type << "'" << std::endl;
         
-        // Step 2: Enter the method scope.
-        symbolTable.enterScope(methodName);
+            // Step 1: Add the method symbol to the enclosing class's scope.
+            if (!symbolTable.currentScopeStack.empty()) {
+                size_t classScopeIndex = symbolTable.currentScopeStack.top(); // Enclosing class scope.
+                string bombaCLATTTTTTTTTT = returnTypeNode->type;
+                if(returnTypeNode->type == "Identifier"){
+                    bombaCLATTTTTTTTTT = returnTypeNode->value;
+                }
+                if (!symbolTable.scopes[classScopeIndex].addSymbol(methodName, SymbolKind::Method, bombaCLATTTTTTTTTT, std::vector<Symbol>(), methodNameNode->lineno)) {
+                    std::cerr << "@error at line " << methodNameNode->lineno 
+                              << ": Duplicate method declaration: '" << methodName << "'" << std::endl;
+                    symbolTable.addError("Duplicate method declaration", methodNameNode->lineno);
+                } else {
+                    // Methods are numbered in source order, the order code generation emits them in.
+                    symbolTable.scopes[classScopeIndex].symbols[methodName].methodId = ++symbolTable.methodCount;
+                }
+            }
         
-        // Step 3: Within the method scope, add the method symbol again to allow recursive calls.
-        if (!symbolTable.scopes[symbolTable.currentScopeStack.top()].addSymbol(methodName, SymbolKind::Method, returnTypeNode->type, std::vector<Symbol>(), methodNameNode->lineno)) {
-            std::cerr << "@error at line " << methodNameNode->lineno 
-                      << ": Duplicate recursive method declaration for '" << methodName << "'" << std::endl;
-            symbolTable.addError("Duplicate recursive method declaration", methodNameNode->lineno);
-        }
+            // Step 2: Enter the method scope.
+            symbolTable.enterScope(methodName);
         
-        // Step 4: Process the rest of the children (parameters, method body, etc.)
-        ++it;
-        for (; it != node->children.end(); ++it) {
-            traverseTree(*it, symbolTable);
-        }
+            // Step 3: Within the method scope, add the method symbol again to allow recursive calls.
+            if (!symbolTable.scopes[symbolTable.currentScopeStack.top()].addSymbol(methodName, SymbolKind::Method, returnTypeNode->type, std::vector<Symbol>(), methodNameNode->lineno)) {
+                std::cerr << "@error at line " << methodNameNode->lineno 
+                          << ": Duplicate recursive method declaration for '" << methodName << "'" << std::endl;
+                symbolTable.addError("Duplicate recursive method declaration", methodNameNode->lineno);
+            }
         
-        // Step 5: Exit the method scope.
-        symbolTable.exitScope();
-    }
-     else if (node->type == "varDeclaration") {
-        auto it = node->children.begin();
-        Node* varTypeNode = *it;
-        ++it;
-        Node* varNameNode = *it;
-        std::string varName = varNameNode->value;
-        // If the type node's type is "Identifier", use its value as the actual type.
-        std::string varType = (varTypeNode->type == "Identifier") ? varTypeNode->value : varTypeNode->type;
+            // Step 4: Process the rest of the children (parameters, method body, etc.)
+            ++it;
+            for (; it != node->children.end(); ++it) {
+                children.push_back(*it);
+            }
         
-        if (!symbolTable.addSymbolST(varName, SymbolKind::Variable, varType, std::vector<Symbol>(), varNameNode->lineno)){
-            std::cerr << "@error at line " << varNameNode->lineno
-                      << ". Already Declared variable: '" << varName << "'" << std::endl;
-            symbolTable.addError("Already declared variable", varNameNode->lineno);
+            // Step 5: Exit the method scope once its children are done.
+            work.push_back(nullptr);
         }
-        
-        for (++it; it != node->children.end(); ++it)
-            traverseTree(*it, symbolTable);
-    
-    } else if (node->type == "Parameter") {
-        // Revised Parameter branch:
-        // If the node has exactly two children, treat it as one parameter.
-        // If more than two children, assume it contains a flat list of (type, identifier) pairs.
-        if (node->children.size() == 2) {
+         else if (node->type == "varDeclaration") {
             auto it = node->children.begin();
-            Node* paramTypeNode = *it;
-            string itsIdentifierChangeItPls = "";
-            if (paramTypeNode->type == "Identifier")
-            {
-                itsIdentifierChangeItPls = paramTypeNode->value;
-            }
-            else
-            {
-                itsIdentifierChangeItPls = paramTypeNode->type;
-            }
-            
-            cout << "itsIdentifierChangeItPlsaaa " << itsIdentifierChangeItPls << endl;
-            
+            Node* varTypeNode = *it;
             ++it;
-            Node* paramNameNode = *it;
-            std::string paramName = paramNameNode->value;
-            cout << "itsIdentifierChangeItPls Parameter traverse tree i cant hold it in anymore : " << itsIdentifierChangeItPls << endl;
-            if (!symbolTable.addSymbolST(paramName, SymbolKind::Variable, itsIdentifierChangeItPls, std::vector<Symbol>(), paramNameNode->lineno)){
-                std::cerr << "@error at line " << paramNameNode->lineno
-                          << ". Already Declared parameter: '" << paramName << "'" << std::endl;
-                symbolTable.addError("Already declared parameter", paramNameNode->lineno);
-
+            Node* varNameNode = *it;
+            std::string varName = varNameNode->value;
+            // If the type node's type is "Identifier", use its value as the actual type.
+            std::string varType = (varTypeNode->type == "Identifier") ? varTypeNode->value : varTypeNode->type;
+        
+            if (!symbolTable.addSymbolST(varName, SymbolKind::Variable, varType, std::vector<Symbol>(), varNameNode->lineno)){
+                std::cerr << "@error at line " << varNameNode->lineno
+                          << ". Already Declared variable: '" << varName << "'" << std::endl;
+                symbolTable.addError("Already declared variable", varNameNode->lineno);
             }
-        } else {
-            // Process children in pairs.
-            auto it = node->children.begin();
-            while (it != node->children.end()) {
+        
+            for (++it; it != node->children.end(); ++it)
+                children.push_back(*it);
+    
+        } else if (node->type == "Parameter") {
+            // Revised Parameter branch:
+            // If the node has exactly two children, treat it as one parameter.
+            // If more than two children, assume it contains a flat list of (type, identifier) pairs.
+            if (node->children.size() == 2) {
+                auto it = node->children.begin();
                 Node* paramTypeNode = *it;
                 string itsIdentifierChangeItPls = "";
                 if (paramTypeNode->type == "Identifier")
@@ -733,49 +754,78 @@ void traverseTree(Node* node, SymbolTable& symbolTable) {
                 {
                     itsIdentifierChangeItPls = paramTypeNode->type;
                 }
-                
-                cout << "itsIdentifierChangeItPlsbbbb " << itsIdentifierChangeItPls << endl;
+            
+                // cout << "itsIdentifierChangeItPlsaaa " << itsIdentifierChangeItPls << endl;
+            
                 ++it;
-                if (it == node->children.end()) break;
                 Node* paramNameNode = *it;
-                ++it;
                 std::string paramName = paramNameNode->value;
+                // cout << "itsIdentifierChangeItPls Parameter traverse tree i cant hold it in anymore : " << itsIdentifierChangeItPls << endl;
                 if (!symbolTable.addSymbolST(paramName, SymbolKind::Variable, itsIdentifierChangeItPls, std::vector<Symbol>(), paramNameNode->lineno)){
                     std::cerr << "@error at line " << paramNameNode->lineno
                               << ". Already Declared parameter: '" << paramName << "'" << std::endl;
                     symbolTable.addError("Already declared parameter", paramNameNode->lineno);
+
+                }
+            } else {
+                // Process children in pairs.
+                auto it = node->children.begin();
+                while (it != node->children.end()) {
+                    Node* paramTypeNode = *it;
+                    string itsIdentifierChangeItPls = "";
+                    if (paramTypeNode->type == "Identifier")
+                    {
+                        itsIdentifierChangeItPls = paramTypeNode->value;
+                    }
+                    else
+                    {
+                        itsIdentifierChangeItPls = paramTypeNode->type;
+                    }
+                
+                    // cout << "itsIdentifierChangeItPlsbbbb " << itsIdentifierChangeItPls << endl;
+                    ++it;
+                    if (it == node->children.end()) break;
+                    Node* paramNameNode = *it;
+                    ++it;
+                    std::string paramName = paramNameNode->value;
+                    if (!symbolTable.addSymbolST(paramName, SymbolKind::Variable, itsIdentifierChangeItPls, std::vector<Symbol>(), paramNameNode->lineno)){
+                        std::cerr << "@error at line " << paramNameNode->lineno
+                                  << ". Already Declared parameter: '" << paramName << "'" << std::endl;
+                        symbolTable.addError("Already declared parameter", paramNameNode->lineno);
+                    }
                 }
             }
-        }
-    } else if (node->type == "ParameterList") {
-        // If children are Parameter nodes, process each.
-        if (!node->children.empty() && (*node->children.begin())->type == "Parameter") {
-            for (Node* param : node->children)
-                traverseTree(param, symbolTable);
-        } else {
-            // Otherwise, process as flat pairs.
-            auto it = node->children.begin();
-            while (it != node->children.end()) {
-                Node* typeNode = *it;
-                ++it;
-                if (it == node->children.end()) break;
-                Node* idNode = *it;
-                ++it;
-                std::string paramName = idNode->value;
-                Node* paramTypeNode = *it;
-                ++it;
-                Node* paramNameNode = *it;
-                if (!symbolTable.addSymbolST(paramName, SymbolKind::Variable, typeNode->type, std::vector<Symbol>(), paramNameNode->lineno)){
-                    std::cerr << "@error at line " << idNode->lineno
-                              << ". Already Declared parameter: '" << paramName << "'" << std::endl;
-                    symbolTable.addError("Already declared parameter", idNode->lineno);
+        } else if (node->type == "ParameterList") {
+            // If children are Parameter nodes, process each.
+            if (!node->children.empty() && (*node->children.begin())->type == "Parameter") {
+                for (Node* param : node->children)
+                    children.push_back(param);
+            } else {
+                // Otherwise, process as flat pairs.
+                auto it = node->children.begin();
+                while (it != node->children.end()) {
+                    Node* typeNode = *it;
+                    ++it;
+                    if (it == node->children.end()) break;
+                    Node* idNode = *it;
+                    ++it;
+                    std::string paramName = idNode->value;
+                    ++it;
+                    Node* paramNameNode = *it;
+                    if (!symbolTable.addSymbolST(paramName, SymbolKind::Variable, typeNode->type, std::vector<Symbol>(), paramNameNode->lineno)){
+                        std::cerr << "@error at line " << idNode->lineno
+                                  << ". Already Declared parameter: '" << paramName << "'" << std::endl;
+                        symbolTable.addError("Already declared parameter", idNode->lineno);
+                    }
                 }
             }
+        } else {
+            // Default: traverse all children.
+            for (Node* child : node->children)
+                children.push_back(child);
         }
-    } else {
-        // Default: traverse all children.
-        for (Node* child : node->children)
-            traverseTree(child, symbolTable);
+
+        work.insert(work.end(), children.rbegin(), children.rend());
     }
 }
 
@@ -802,7 +852,7 @@ void processParameterList(Node* paramListNode, SymbolTable& symbolTable) {
                     {
                         itsIdentifierChangeItPls = typeNode->type;
                     }
-                    cout << "itsIdentifierChangeItPls processParameterList " << itsIdentifierChangeItPls << endl;
+                    // cout << "itsIdentifierChangeItPls processParameterList " << itsIdentifierChangeItPls << endl;
 
                     Node* identifierNode = *it; // e.g., "num"
                     std::string paramName = identifierNode->value;
@@ -839,172 +889,188 @@ void processParameterList(Node* paramListNode, SymbolTable& symbolTable) {
 }
 
 //
-// performSemanticAnalysis: Recursively traverses the AST to perform semantic analysis.
+// performSemanticAnalysis: Traverses the AST to perform semantic analysis. The walk keeps an explicit
+// work list instead of recursing, so deeply nested programs cannot overflow the call stack.
 // Duplicate identifier checks are not performed here, because they are handled during the symbol table construction.
 // This function primarily checks that each identifier used is declared in an accessible scope.
 //
 
 
 void performSemanticAnalysis(Node* node, SymbolTable& symbolTable) {
+    std::vector<Node*> work;      // Nodes still to visit, next one last; nullptr exits a scope.
+    std::vector<Node*> children;  // Children of the current node to visit next, in source order.
+    if (node) work.push_back(node);
+
+    while (!work.empty()) {
+        node = work.back();
+        work.pop_back();
+        if (!node) {
+            symbolTable.exitScope();
+            continue;
+        }
+        children.clear();
 
-    if (!node) return;
-
-    // std::cout << "[DEBUG] Entering node: Type='" << node->type
-                             // << "', Value='" << node->value
-                             // << "', Line=" << node->lineno << std::endl;
+        // std::cout << "[DEBUG] Entering node: Type='" << node->type
+                                 // << "', Value='" << node->value
+                                 // << "', Line=" << node->lineno << std::endl;
 
-    // New class scope: process classDeclaration or mainClass.
-    if (node->type == "classDeclaration" || node->type == "mainClass") {
-        auto it = node->children.begin();
-        Node* classIdentifierNode = *it;
-        std::string className = classIdentifierNode->value;
-        whatClassWeAreInRn = className;
+        // New class scope: process classDeclaration or mainClass.
+        if (node->type == "classDeclaration" || node->type == "mainClass") {
+            auto it = node->children.begin();
+            Node* classIdentifierNode = *it;
+            std::string className = classIdentifierNode->value;
+            whatClassWeAreInRn = className;
         
-        // Enter the class scope.
-        symbolTable.enterScope(className);
-
-        for (++it; it != node->children.end(); ++it) {
-            performSemanticAnalysis(*it, symbolTable);
-        }
+            // Enter the class scope.
+            symbolTable.enterScope(className);
 
-        // Exit the class scope.
-        symbolTable.exitScope();
-    }
-    // New method scope: process methodDeclaration.
-    else if (node->type == "methodDeclaration" || node->type == "Method") {
-        auto it = node->children.begin();
-        Node* returnTypeNode = *it; // e.g., "IntType"
-        ++it;
-        Node* methodIdentifierNode = *it; // Method name.
-        std::string methodName = methodIdentifierNode->value;
-        // std::cout << "[DEBUG SEMANTIC] Found method declaration: '" << methodName 
-                             // << "' with return type: '" << returnTypeNode->type << "'" << std::endl;
-
-        // Enter the method scope.
-        symbolTable.enterScope(methodName);
-
-        ++it;
-        for (; it != node->children.end(); ++it) {
-            Node* child = *it;
-            if (child->type == "ParameterList") {
-                // Process parameters.
-                processParameterList(child, symbolTable);
-            } else {
-                // Recurse for method body, statements, etc.
-                performSemanticAnalysis(child, symbolTable);
+            for (++it; it != node->children.end(); ++it) {
+                children.push_back(*it);
             }
+
+            // Exit the class scope once its children are done.
+            work.push_back(nullptr);
         }
+        // New method scope: process methodDeclaration.
+        else if (node->type == "methodDeclaration" || node->type == "Method") {
+            auto it = node->children.begin();
+            ++it;   // Past the return type, e.g. "IntType".
+            Node* methodIdentifierNode = *it; // Method name.
+            std::string methodName = methodIdentifierNode->value;
+            // std::cout << "[DEBUG SEMANTIC] Found method declaration: '" << methodName 
+                                 // << "' with return type: '" << returnTypeNode->type << "'" << std::endl;
 
-        // Exit the method scope.
-        symbolTable.exitScope();
-    }
-    // Assignment: Check that the identifier on the left-hand side is declared.
-    else if (node->type == "assign") {
-        // 1. Process the Left-Hand Side (LHS)
-        auto it = node->children.begin();
-        Node* lhsIdentifierNode = *it; // First child: LHS identifier
-        Symbol* lhsSymbol = symbolTable.findSymbol(lhsIdentifierNode->value);
-        if (!lhsSymbol) {
-            std::cerr << "@error at line " << lhsIdentifierNode->lineno
-                      << ": Undeclared symbol '" << lhsIdentifierNode->value << "'"
-                      << std::endl;
-            symbolTable.addError("Undeclared symbol", lhsIdentifierNode->lineno);
-        } else {
-            // std::cout << "[DEBUG] LHS symbol '" << lhsSymbol->name << "' lineNr symbol declared: " <<  lhsSymbol->lineOfDeclaration
-                             // << "but Assign declared node at: " << node->lineno << "' with type '" << lhsSymbol->type << "' found." << std::endl;
-            if(lhsSymbol->lineOfDeclaration > node->lineno){
-                cout << "Variable used before declaration " << endl;
-                std::cerr << "@error at line " << lhsIdentifierNode->lineno 
-                      << ": Variable '" << lhsIdentifierNode->value 
-                      << "' is used before its declaration (declared at line " 
-                      << lhsSymbol->lineOfDeclaration << ")." << std::endl;
-                symbolTable.addError("Variable used before declaration", lhsIdentifierNode->lineno);
+            // Enter the method scope.
+            symbolTable.enterScope(methodName);
+
+            ++it;
+            for (; it != node->children.end(); ++it) {
+                Node* child = *it;
+                if (child->type == "ParameterList") {
+                    // Process parameters.
+                    processParameterList(child, symbolTable);
+                } else {
+                    // Visit the method body, statements, etc.
+                    children.push_back(child);
+                }
             }
+
+            // Exit the method scope once its children are done.
+            work.push_back(nullptr);
         }
+        // Assignment: Check that the identifier on the left-hand side is declared.
+        else if (node->type == "assign") {
+            // 1. Process the Left-Hand Side (LHS)
+            auto it = node->children.begin();
+            Node* lhsIdentifierNode = *it; // First child: LHS identifier
+            Symbol* lhsSymbol = symbolTable.findSymbol(lhsIdentifierNode->value);
+            if (!lhsSymbol) {
+                std::cerr << "@error at line " << lhsIdentifierNode->lineno
+                          << ": Undeclared symbol '" << lhsIdentifierNode->value << "'"
+                          << std::endl;
+                symbolTable.addError("Undeclared symbol", lhsIdentifierNode->lineno);
+            } else {
+                // std::cout << "[DEBUG] LHS symbol '" << lhsSymbol->name << "' lineNr symbol declared: " <<  lhsSymbol->lineOfDeclaration
+                                 // << "but Assign declared node at: " << node->lineno << "' with type '" << lhsSymbol->type << "' found." << std::endl;
+                if(lhsSymbol->lineOfDeclaration > node->lineno){
+                    // cout << "Variable used before declaration " << endl;
+                    std::cerr << "@error at line " << lhsIdentifierNode->lineno 
+                          << ": Variable '" << lhsIdentifierNode->value 
+                          << "' is used before its declaration (declared at line " 
+                          << lhsSymbol->lineOfDeclaration << ")." << std::endl;
+                    symbolTable.addError("Variable used before declaration", lhsIdentifierNode->lineno);
+                }
+            }
     
-        // 2. Process the Right-Hand Side (RHS)
-        ++it;
-        if (it != node->children.end()) {
-            Node* rhsExpressionNode = *it;
+            // 2. Process the Right-Hand Side (RHS)
+            ++it;
+            if (it != node->children.end()) {
+                Node* rhsExpressionNode = *it;
     
-            // Use evaluateExpressionType to get the final type of the RHS
-            cout << "rhsExpressionNode->type here: " << rhsExpressionNode->type << endl;
-            std::string rhsType = evaluateExpressionType(rhsExpressionNode, symbolTable);
-            // If the RHS node itself is an identifier, ensure we use the type from the symbol table.
-            // std::cout << "[DEBUG] RHS expression evaluated to type if Identifier we fix: " << rhsType << std::endl;
-            if (rhsExpressionNode->type == "Identifier") {
-                //symbolTable.enterScope(); // where do we enter scope
-                Symbol* rhsSym = symbolTable.findSymbol(rhsExpressionNode->value);
-                // exit scope after?
-                cout << "rhsSym " << rhsSym << endl;
-                if (rhsSym) {
-                    rhsType = rhsSym->type;
-                    cout << "RECASTED!!" << endl;
+                // Use evaluateExpressionType to get the final type of the RHS
+                // cout << "rhsExpressionNode->type here: " << rhsExpressionNode->type << endl;
+                std::string rhsType = evaluateExpressionType(rhsExpressionNode, symbolTable);
+                // If the RHS node itself is an identifier, ensure we use the type from the symbol table.
+                // std::cout << "[DEBUG] RHS expression evaluated to type if Identifier we fix: " << rhsType << std::endl;
+                if (rhsExpressionNode->type == "Identifier") {
+                    //symbolTable.enterScope(); // where do we enter scope
+                    Symbol* rhsSym = symbolTable.findSymbol(rhsExpressionNode->value);
+                    // exit scope after?
+                    // cout << "rhsSym " << rhsSym << endl;
+                    if (rhsSym) {
+                        rhsType = rhsSym->type;
+                        // cout << "RECASTED!!" << endl;
+                    }
                 }
-            }
-            // std::cout << "[DEBUG] RHS expression evaluated to type if Identifier we FIXED: " << rhsType << std::endl;
+                // std::cout << "[DEBUG] RHS expression evaluated to type if Identifier we FIXED: " << rhsType << std::endl;
 
     
-            // 3. If LHS is declared, check for type mismatch
-            if (lhsSymbol) {
-                // Only report a mismatch if we have a valid RHS type (not "unknown")
-                if (rhsType != "unknown" && lhsSymbol->type != rhsType) {
-                    std::cerr << "@error at line " << node->lineno
-                              << ": Type mismatch; variable '" << lhsIdentifierNode->value
-                              << "' has type '" << lhsSymbol->type
-                              << "', but RHS expression is of type '" << rhsType << "'"
-                              << std::endl;
-                    symbolTable.addError("Type mismatch in assignment", node->lineno);
+                // 3. If LHS is declared, check for type mismatch
+                if (lhsSymbol) {
+                    // Only report a mismatch if we have a valid RHS type (not "unknown")
+                    if (rhsType != "unknown" && lhsSymbol->type != rhsType) {
+                        std::cerr << "@error at line " << node->lineno
+                                  << ": Type mismatch; variable '" << lhsIdentifierNode->value
+                                  << "' has type '" << lhsSymbol->type
+                                  << "', but RHS expression is of type '" << rhsType << "'"
+                                  << std::endl;
+                        symbolTable.addError("Type mismatch in assignment", node->lineno);
+                    }
                 }
             }
-        }
     
-        // 4. Recurse on children for deeper analysis
-        for (auto childIt = node->children.begin(); childIt != node->children.end(); ++childIt) {
-            performSemanticAnalysis(*childIt, symbolTable);
+            // 4. Visit children for deeper analysis
+            for (auto childIt = node->children.begin(); childIt != node->children.end(); ++childIt) {
+                children.push_back(*childIt);
+            }
         }
-    }
-    else if (node->type == "varDeclaration") {
-        auto it = node->children.begin();
-        Node* varTypeNode = *it;
-        ++it;
-        Node* varNameNode = *it;
-        std::string varName = varNameNode->value;
+        else if (node->type == "varDeclaration") {
+            auto it = node->children.begin();
+            Node* varTypeNode = *it;
+            ++it;
+            Node* varNameNode = *it;
+            std::string varName = varNameNode->value;
         
-        // Determine the declared type.
-        std::string varType;
-        if (varTypeNode->type == "Identifier") {
-            // When the type is an identifier, use its value as the type name.
-            varType = varTypeNode->value;
-            cout << "varTypeNode->value HEREEE " << varTypeNode->value << endl;
-            // Look up the type (class) in the symbol table.
-            Symbol* classSymbol = symbolTable.findSymbol(varType);
-            // If not found or not of kind Class, report an error.
-            if (!classSymbol) {
-                std::cerr << "@error at line " << varTypeNode->lineno
-                          << ": Undefined class '" << varType << "'" << std::endl;
-                symbolTable.addError("Undefined class again", varTypeNode->lineno);
+            // Determine the declared type.
+            std::string varType;
+            if (varTypeNode->type == "Identifier") {
+                // When the type is an identifier, use its value as the type name.
+                varType = varTypeNode->value;
+                // cout << "varTypeNode->value HEREEE " << varTypeNode->value << endl;
+                // Look up the type (class) in the symbol table.
+                Symbol* classSymbol = symbolTable.findSymbol(varType);
+                // If not found or not of kind Class, report an error.
+                if (!classSymbol) {
+                    std::cerr << "@error at line " << varTypeNode->lineno
+                              << ": Undefined class '" << varType << "'" << std::endl;
+                    symbolTable.addError("Undefined class again", varTypeNode->lineno);
+                }
+            } else {
+                // Otherwise, use the node's type.
+                varType = varTypeNode->type;
             }
-        } else {
-            // Otherwise, use the node's type.
-            varType = varTypeNode->type;
-        }
         
-        // Process any additional children.
-        for (++it; it != node->children.end(); ++it)
-            traverseTree(*it, symbolTable);
-    }
+            // Process any additional children.
+            for (++it; it != node->children.end(); ++it)
+                traverseTree(*it, symbolTable);
+        }
     
     
-    else {
-        // Default: Recursively analyze all children.
-        for (Node* child : node->children) {
-            performSemanticAnalysis(child, symbolTable);
+        else {
+            // Calls outside assignments have not been typed yet; typing one resolves its method.
+            if (node->type == "methodCall" && node->resolved.empty())
+                evaluateExpressionType(node, symbolTable);
+            // Default: analyze all children.
+            for (Node* child : node->children) {
+                children.push_back(child);
+            }
         }
-    }
 
-    // std::cout << "[DEBUG] Exiting node: Type='" << node->type
-                             // << "', Value='" << node->value << "'" << std::endl;
+        // std::cout << "[DEBUG] Exiting node: Type='" << node->type
+                                 // << "', Value='" << node->value << "'" << std::endl;
+
+        work.insert(work.end(), children.rbegin(), children.rend());
+    }
 }
 
 
@@ -0,0 +1,77 @@
+// Tail-call elimination: a method calling itself on 'this' as the last thing it does
+// reassigns its parameters and jumps back to its start, so deep recursion of that kind
+// runs in one frame instead of one frame per call.
+
+// Returns true when the value of 'name', computed by instruction 'index' of 'block', is
+// returned unchanged: only copies of it into variables follow, on a path of gotos ending
+// in its return.
+static bool returnedUnchanged(const Function* function, std::string name, BasicBlock* block, size_t index) {
+    std::set<BasicBlock*> seen;
+    for (size_t i = index + 1; ; i++) {
+        if (i == block->instructions.size()) return false;
+        const Instruction &inst = block->instructions[i];
+        if (inst.kind == Instruction::Comment) continue;
+        if (inst.kind == Instruction::Copy && inst.args[0] == name && !function->isField(inst.dst)) { name = inst.dst; continue; }
+        if (inst.kind == Instruction::Return) return inst.args[0] == name;
+        if (inst.kind != Instruction::Goto || !seen.insert(inst.target).second) return false;
+        block = inst.target;
+        i = (size_t)-1;
+    }
+}
+
+// Rewrites every self tail call and returns the number rewritten. The entry block is
+// split first so the jump back lands on a block of its own: the entry keeps no
+// predecessors, which SSA construction relies on.
+int IR::eliminateTailCalls() {
+    int total = 0;
+    for (size_t f = 0; f < functions.size(); f++) {
+        Function* function = functions[f];
+        BasicBlock* body = nullptr;
+        std::vector<std::string> resets;
+        for (size_t b = 0; b < function->blocks.size(); b++) {
+            BasicBlock* block = function->blocks[b];
+            for (size_t i = 0; i < block->instructions.size(); i++) {
+                const Instruction call = block->instructions[i];
+                if (call.kind != Instruction::Call || call.method != (int)f || call.args[0] != "this" ||
+                    !returnedUnchanged(function, call.dst, block, i))
+                    continue;
+
+                if (!body) {
+                    // Locals read before being assigned start at 0, in every call.
+                    BasicBlock* entry = function->entry();
+                    computeLiveness(function);
+                    for (const std::string &name : entry->liveIn)
+                        if (function->locals.count(name) && std::find(function->params.begin(), function->params.end(), name) == function->params.end())
+                            resets.push_back(name);
+                    body = createBlock(function);
+                    body->instructions.swap(entry->instructions);
+                    body->successors.swap(entry->successors);
+                    entry->addInstruction(Instruction(Instruction::Goto, "", "", {}, body));
+                    entry->addSuccessor(body);
+                    if (block == entry) block = body;
+                }
+                block->instructions.erase(block->instructions.begin() + i, block->instructions.end());
+                block->successors.clear();
+
+                // Arguments naming a parameter are read before any parameter is written.
+                std::vector<std::string> values(call.args.begin() + 1, call.args.end());
+                for (std::string &value : values)
+                    if (std::find(function->params.begin(), function->params.end(), value) != function->params.end()) {
+                        std::string staged = newTemp();
+                        block->addInstruction(Instruction(Instruction::Copy, staged, "", {value}));
+                        value = staged;
+                    }
+                for (size_t p = 0; p < function->params.size() && p < values.size(); p++)
+                    block->addInstruction(Instruction(Instruction::Copy, function->params[p], "", {values[p]}, nullptr, "tail call"));
+                for (const std::string &name : resets)
+                    block->addInstruction(Instruction(Instruction::Const, name, "0", {}, nullptr, "tail call"));
+                block->addInstruction(Instruction(Instruction::Goto, "", "", {}, body, "tail call " + function->name));
+                block->addSuccessor(body);
+                function->optCounts["tail_calls"]++;
+                total++;
+                break;
+            }
+        }
+    }
+    return total;
+}
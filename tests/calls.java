@@ -0,0 +1,48 @@
+// Calls are resolved at compile time from the receiver's static type. Methods with the same
+// name in different classes, receivers that are the results of other calls and arguments
+// that are calls themselves must each reach the right method.
+public class Calls {
+    public static void main(String[] a) {
+        System.out.println(new Box().init(5).twin().get());
+        System.out.println(new Pair().run());
+    }
+}
+class Box {
+    int v;
+    public Box init(int x) {
+        v = x;
+        return this;
+    }
+    public Box twin() {
+        Box other;
+        other = new Box();
+        return other.init(v * 10);
+    }
+    public int get() {
+        return v;
+    }
+}
+class Other {
+    int v;
+    public Other init(int x) {
+        v = x + 1000;
+        return this;
+    }
+    public int get() {
+        return v * 2;
+    }
+}
+class Pair {
+    public int add(int x, int y) {
+        return (x * 100) + y;
+    }
+    public int run() {
+        Box b;
+        Other o;
+        b = new Box().init(1);
+        o = new Other().init(2);
+        System.out.println(b.get());
+        System.out.println(o.get());
+        return this.add(b.get(), this.add(o.get(), b.twin().get()));
+    }
+}
@@ -0,0 +1,54 @@
+// Comparisons that decide a branch become compare-and-branch instructions; each must branch
+// the same way as the comparison computed as a value, on either side of equality. Prints
+// code * 1000 + asValues for each x and y in -2, 0, 2, then the loop count.
+public class CompareBranch {
+    public static void main(String[] a) {
+        System.out.println(new C().table(0 - 2, 3));
+    }
+}
+class C {
+    public int code(int x, int y) {
+        int r;
+        r = 0;
+        if (x < y) r = r + 1;
+        if (x > y) r = r + 2;
+        if (x == y) r = r + 4;
+        if (!(x < y)) r = r + 8;
+        if (!(x > y)) r = r + 16;
+        if (!(x == y)) r = r + 32;
+        return r;
+    }
+    public int asValues(int x, int y) {
+        boolean lt; boolean gt; boolean eq; int r;
+        lt = x < y;
+        gt = x > y;
+        eq = x == y;
+        r = 0;
+        if (lt) r = r + 1;
+        if (gt) r = r + 2;
+        if (eq) r = r + 4;
+        if (lt == (y > x)) r = r + 64;
+        return r;
+    }
+    public int loops(int x, int y) {
+        int n;
+        n = 0;
+        while (x < y) { x = x + 1; n = n + 1; }
+        while (y > (x - 3)) { y = y - 1; n = n + 10; }
+        while (!(x == y)) { y = y + 1; n = n + 100; }
+        return n;
+    }
+    public int table(int lo, int hi) {
+        int x; int y;
+        x = lo;
+        while (x < (hi + 1)) {
+            y = lo;
+            while (y < (hi + 1)) {
+                System.out.println(((this.code(x, y)) * 1000) + (this.asValues(x, y)));
+                y = y + 2;
+            }
+            x = x + 2;
+        }
+        return this.loops(lo, hi);
+    }
+}
@@ -0,0 +1,23 @@
+// The operand stack is sized from the deepest point of each method, here a call with its
+// receiver and ten arguments on it. The intermediate values of a deeply nested expression
+// take frame slots instead.
+public class DeepStack {
+    public static void main(String[] a) {
+        System.out.println(new D().sum());
+        System.out.println(new D().calls());
+    }
+}
+class D {
+    public int add(int x, int y) {
+        return x + y;
+    }
+    public int ten(int a, int b, int c, int d, int e, int f, int g, int h, int i, int j) {
+        return (((((((((a + (b * 2)) + (c * 3)) + (d * 4)) + (e * 5)) + (f * 6)) + (g * 7)) + (h * 8)) + (i * 9)) + (j * 10));
+    }
+    public int sum() {
+        return (1 * 1) + ((2 * 1) + ((3 * 1) + ((4 * 1) + ((5 * 1) + ((6 * 1) + ((7 * 1) + ((8 * 1) + ((9 * 1) + ((10 * 1) + ((11 * 1) + ((12 * 1) + ((13 * 1) + ((14 * 1) + ((15 * 1) + ((16 * 1) + ((17 * 1) + ((18 * 1) + ((19 * 1) + ((20 * 1) + ((21 * 1) + ((22 * 1) + ((23 * 1) + ((24 * 1) + ((25 * 1) + ((26 * 1) + ((27 * 1) + ((28 * 1) + ((29 * 1) + ((30 * 1) + ((31 * 1) + ((32 * 1) + ((33 * 1) + ((34 * 1) + ((35 * 1) + ((36 * 1) + ((37 * 1) + ((38 * 1) + ((39 * 1) + ((40 * 1) + ((41 * 1) + ((42 * 1) + ((43 * 1) + ((44 * 1) + ((45 * 1) + ((46 * 1) + ((47 * 1) + ((48 * 1) + ((49 * 1) + ((50 * 1) + ((51 * 1) + ((52 * 1) + ((53 * 1) + ((54 * 1) + ((55 * 1) + ((56 * 1) + ((57 * 1) + ((58 * 1) + ((59 * 1) + (60)))))))))))))))))))))))))))))))))))))))))))))))))))))))))));
+    }
+    public int calls() {
+        return this.ten(this.add(1, 1), this.add(2, 2), this.add(3, 3), this.add(4, 4), this.add(5, 5), this.add(6, 6), this.add(7, 7), this.add(8, 8), this.add(9, 9), this.ten(1, 1, 1, 1, 1, 1, 1, 1, 1, 1));
+    }
+}
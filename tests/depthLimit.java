@@ -0,0 +1,12 @@
+// Recursion that never ends stops at the call depth limit, with status 3, well before the
+// process runs out of stack.
+public class DepthLimit {
+    public static void main(String[] a) {
+        System.out.println(new Deep().down(0));
+    }
+}
+class Deep {
+    public int down(int n) {
+        return (this.down(n + 1)) + 1;
+    }
+}
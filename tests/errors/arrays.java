@@ -0,0 +1,3 @@
+// Arrays pass semantic analysis but code generation does not support them: status 5.
+public class Arrays { public static void main(String[] a) { System.out.println(new C().f()); } }
+class C { public int f() { int[] v; v = new int[3]; return v.length; } }
@@ -0,0 +1,2 @@
+// A character the language does not have: status 1.
+public class Lexical { public static void main(String[] a) { System.out.println(1 # 2); } }
@@ -0,0 +1,2 @@
+// An expression missing its right operand: status 2.
+public class SyntaxError { public static void main(String[] a) { System.out.println(1 + ); } }
@@ -0,0 +1,3 @@
+// A boolean assigned to an int variable: status 4.
+public class TypeMismatch { public static void main(String[] a) { System.out.println(new C().f()); } }
+class C { public int f() { int x; x = true; return x; } }
@@ -0,0 +1,3 @@
+// A name that is neither a variable nor a field, found when generating bytecode: status 5.
+public class Undeclared { public static void main(String[] a) { System.out.println(new C().f()); } }
+class C { public int f() { return x; } }
@@ -0,0 +1,18 @@
+// A local that has the name of a field: inlining bump() into run() must not turn the
+// field's reads and writes into the local's.
+public class FieldShadow { public static void main(String[] a) { System.out.println(new C().run(5)); } }
+class C {
+    int count;
+    public int bump() { count = count + 1; return count; }
+    public int run(int n) {
+        int count;
+        int r;
+        int i;
+        count = 100;
+        i = 0;
+        r = 0;
+        while (i < n) { r = r + this.bump(); i = i + 1; }
+        System.out.println(count);
+        return r;
+    }
+}
@@ -0,0 +1,53 @@
+// Value numbering must not merge computations whose operands changed in between, nor field
+// reads separated by a write or a call.
+public class Gvn {
+    public static void main(String[] a) {
+        System.out.println(new G().same(3, 4));
+        System.out.println(new G().reassigned(3, 4));
+        System.out.println(new G().branches(5, 1));
+        System.out.println(new G().branches(5, 0));
+        System.out.println(new G().fields(7));
+        System.out.println(new G().acrossCall(7));
+    }
+}
+class G {
+    int f;
+    public int same(int x, int y) {
+        int p; int q;
+        p = (x + y) * (x + y);
+        q = (x + y) * (x + y);
+        return p + q;
+    }
+    public int reassigned(int x, int y) {
+        int p; int q;
+        p = x * y;
+        x = x + 1;
+        q = x * y;
+        return (p * 100) + q;
+    }
+    public int branches(int x, int c) {
+        int r;
+        if (c < 1) r = x * 2; else r = x * 3;
+        return r + (x * 2);
+    }
+    public int fields(int v) {
+        int p; int q;
+        f = v;
+        p = f + 1;
+        f = v * 2;
+        q = f + 1;
+        return (p * 100) + q;
+    }
+    public int bump() {
+        f = f + 10;
+        return 0;
+    }
+    public int acrossCall(int v) {
+        int p; int q; int ignored;
+        f = v;
+        p = f * 2;
+        ignored = this.bump();
+        q = f * 2;
+        return (p * 100) + q;
+    }
+}
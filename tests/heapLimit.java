@@ -0,0 +1,28 @@
+// A run that keeps allocating stops once its objects pass the heap limit, with status 3.
+public class HeapLimit {
+    public static void main(String[] a) {
+        System.out.println(new Grow().run());
+    }
+}
+class Cell {
+    int a;
+    int b;
+    int c;
+    public int set(int v) {
+        a = v;
+        return v;
+    }
+}
+class Grow {
+    public int run() {
+        Cell cell;
+        int i;
+        System.out.println(2);
+        i = 0;
+        while (0 < 1) {
+            cell = new Cell();
+            i = cell.set(i + 1);
+        }
+        return i;
+    }
+}
@@ -0,0 +1,80 @@
+// Calls that inlining replaces must behave as calls: parameters are copies, the callee's
+// variables do not clash with the caller's, 'this' is the receiver, and fields of another
+// object stay on that object. The tests run with the default budget, with inlining off and
+// with a budget large enough to inline every method, mutually recursive ones included.
+public class Inline {
+    public static void main(String[] a) {
+        System.out.println(new Caller().run(6));
+    }
+}
+class Counter {
+    int count;
+    public int add(int n) {
+        count = count + n;
+        return count;
+    }
+    public int get() {
+        return count;
+    }
+}
+class Caller {
+    int total;
+    public int inc(int x) {
+        x = x + 1;
+        return x;
+    }
+    public int twice(int x) {
+        int r;
+        r = x + x;
+        return r;
+    }
+    public int addTotal(int n) {
+        total = total + n;
+        return total;
+    }
+    public int viaThis(int n) {
+        return (this.twice(n)) + 1;
+    }
+    public int even(int n) {
+        boolean stop;
+        int r;
+        stop = n < 1;
+        if (stop) r = 1; else r = this.odd(n - 1);
+        return r;
+    }
+    public int odd(int n) {
+        boolean stop;
+        int r;
+        stop = n < 1;
+        if (stop) r = 0; else r = this.even(n - 1);
+        return r;
+    }
+    public int run(int n) {
+        int x;
+        int r;
+        int i;
+        Counter c;
+        Counter d;
+        x = n;
+        r = this.inc(x);
+        System.out.println(x);
+        System.out.println(r);
+        r = this.twice(this.twice(x));
+        System.out.println(r);
+        c = new Counter();
+        d = new Counter();
+        i = 0;
+        while (i < n) {
+            r = c.add(i);
+            r = d.add(1);
+            r = this.addTotal(i * 2);
+            i = i + 1;
+        }
+        System.out.println(c.get());
+        System.out.println(d.get());
+        System.out.println(total);
+        System.out.println(new Caller().viaThis(x));
+        System.out.println(this.even(7));
+        return this.odd(7);
+    }
+}
@@ -0,0 +1,15 @@
+// A run that never ends stops after the instruction budget, with status 3.
+public class InstructionLimit {
+    public static void main(String[] a) {
+        System.out.println(new Spin().run());
+    }
+}
+class Spin {
+    public int run() {
+        int i;
+        System.out.println(1);
+        i = 0;
+        while (0 < 1) i = i + 1;
+        return i;
+    }
+}
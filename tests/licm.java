@@ -0,0 +1,53 @@
+// Loop-invariant code motion and strength reduction, with loops counting up and down.
+public class Licm {
+    public static void main(String[] a) {
+        System.out.println(new L().up(10, 3, 4));
+        System.out.println(new L().down(10, 3, 4));
+        System.out.println(new L().stepped(20, 7));
+        System.out.println(new L().nested(5, 6));
+        System.out.println(new L().invariantWrittenLater(6));
+        System.out.println(new L().zeroTrips(0, 9));
+    }
+}
+class L {
+    public int up(int n, int x, int y) {
+        int i; int s;
+        i = 0; s = 0;
+        while (i < n) { s = s + (x * y) + (i * 5); i = i + 1; }
+        return s;
+    }
+    public int down(int n, int x, int y) {
+        int i; int s;
+        i = n; s = 0;
+        while (0 < i) { s = s + (x * y) + (i * 5); i = i - 1; }
+        return s;
+    }
+    public int stepped(int n, int k) {
+        int i; int s;
+        i = n; s = 0;
+        while (0 < i) { s = s + (i * k); i = i - 3; }
+        return s;
+    }
+    public int nested(int n, int m) {
+        int i; int j; int s;
+        i = 0; s = 0;
+        while (i < n) {
+            j = m;
+            while (0 < j) { s = s + (i * j) + (n * m); j = j - 1; }
+            i = i + 1;
+        }
+        return s;
+    }
+    public int invariantWrittenLater(int n) {
+        int i; int k; int s;
+        i = 0; k = 2; s = 0;
+        while (i < n) { s = s + (k * 3); k = k + i; i = i + 1; }
+        return s;
+    }
+    public int zeroTrips(int n, int x) {
+        int i; int s;
+        i = n; s = 1;
+        while (0 < i) { s = x * x; i = i - 1; }
+        return s;
+    }
+}
@@ -0,0 +1,13 @@
+// Statements of a method body run in source order. The right-recursive varOrStatements rule
+// collected them in reverse: this printed 2, 1, 3.
+public class MethodStatementOrder { public static void main(String[] a) { System.out.println(new P().run()); } }
+class P {
+    public int run() {
+        int x;
+        System.out.println(1);
+        System.out.println(2);
+        x = 3;
+        x = x * 10;
+        return x;
+    }
+}
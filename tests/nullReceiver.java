@@ -0,0 +1,19 @@
+// A call on a variable that holds no object ends the run with a runtime error, status 1.
+public class NullReceiver {
+    public static void main(String[] a) {
+        System.out.println(new Holder().run());
+    }
+}
+class Box {
+    int v;
+    public int get() {
+        return v;
+    }
+}
+class Holder {
+    public int run() {
+        Box b;
+        System.out.println(3);
+        return b.get();
+    }
+}
@@ -0,0 +1,124 @@
+#!/bin/sh
+# Regression tests: compiles every program in tests/, plain, with -O, and with -O and
+# inlining off or allowed for any method, runs the bytecode and compares what it prints
+# with the program's .expected file; compiled with --single-pass, plain and with -O, it
+# must give the same bytecode byte for byte. A program with a .vmargs file is run with the
+# interpreter options it holds. For a program that is expected to fail, its .expected file
+# holds what it prints to stdout and then a "status N" line with the interpreter's exit
+# status; what it prints to stderr, counters included, is not compared. A program with a
+# .report file is also compiled with -O --opt-report, and what each pass did must match it.
+# Usage: tests/run.sh   (run "make check" to build the compiler and interpreter first)
+
+TEST_DIR=$(cd "$(dirname "$0")" && pwd)
+COMPILER=${COMPILER:-$TEST_DIR/../compiler}
+INTERPRETER=${INTERPRETER:-$TEST_DIR/../interpreter}
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+failures=0
+
+# check NAME EXPECTED ACTUAL: reports whether the file ACTUAL matches EXPECTED.
+check() {
+    if cmp -s "$2" "$3"; then
+        echo "ok   $1"
+    else
+        echo "FAIL $1"
+        diff "$2" "$3"
+        failures=$((failures + 1))
+    fi
+}
+
+for program in "$TEST_DIR"/*.java; do
+    name=$(basename "$program" .java)
+    vmargs=$(cat "$TEST_DIR/$name.vmargs" 2>/dev/null)
+    for flags in "" "-O" "-O --inline-budget=0" "-O --inline-budget=1000"; do
+        rm -f "$WORK/output.class"
+        (cd "$WORK" && "$COMPILER" $flags "$program" > compile.log 2>&1)
+        if grep -q '^status ' "$TEST_DIR/$name.expected"; then
+            (cd "$WORK" && "$INTERPRETER" $vmargs output.class > run.log 2> /dev/null
+             echo "status $?" >> run.log)
+        else
+            (cd "$WORK" && "$INTERPRETER" $vmargs output.class > run.log 2>&1)
+        fi
+        check "$name $flags" "$TEST_DIR/$name.expected" "$WORK/run.log"
+    done
+    # --single-pass must produce exactly the bytecode of a normal compile.
+    for flags in "" "-O"; do
+        rm -f "$WORK/output.class" "$WORK/normal.class"
+        (cd "$WORK" && "$COMPILER" $flags "$program" > compile.log 2>&1 && mv output.class normal.class
+         "$COMPILER" $flags --single-pass "$program" > compile.log 2>&1)
+        check "$(echo $name $flags --single-pass)" "$WORK/normal.class" "$WORK/output.class"
+    done
+    if [ -f "$TEST_DIR/$name.report" ]; then
+        (cd "$WORK" && "$COMPILER" -O --opt-report "$program" > compile.log 2> report.log)
+        check "$name --opt-report" "$TEST_DIR/$name.report" "$WORK/report.log"
+    fi
+done
+# Programs that must not compile: the compiler must exit with the status in the program's
+# .expected file and write no output.class.
+for program in "$TEST_DIR"/errors/*.java; do
+    name=$(basename "$program" .java)
+    for flags in "" "-O" "--single-pass"; do
+        rm -f "$WORK/output.class"
+        (cd "$WORK" && "$COMPILER" $flags "$program" > compile.log 2>&1
+         echo "status $?" > status.log
+         if [ -f output.class ]; then echo "output.class written" >> status.log; fi)
+        check "errors/$name $flags" "$TEST_DIR/errors/$name.expected" "$WORK/status.log"
+    done
+done
+
+# The compile server: a compile through --connect must give the same status, stdout,
+# stderr and bytecode as the same compile done locally.
+mkdir "$WORK/server" "$WORK/local" "$WORK/remote"
+SOCKET=$WORK/server/compile.sock
+(cd "$WORK/server" && exec "$COMPILER" --serve="$SOCKET" > server.log 2>&1) &
+server=$!
+trap 'kill $server 2> /dev/null; rm -rf "$WORK"' EXIT
+tries=0
+while [ ! -S "$SOCKET" ] && [ $tries -lt 50 ]; do
+    sleep 0.1
+    tries=$((tries + 1))
+done
+for program in "$TEST_DIR"/*.java "$TEST_DIR"/errors/*.java; do
+    name=${program#$TEST_DIR/}
+    for flags in "" "-O"; do
+        for side in local remote; do
+            connect=
+            if [ $side = remote ]; then connect=--connect=$SOCKET; fi
+            rm -f "$WORK/$side/output.class"
+            (cd "$WORK/$side" && "$COMPILER" $connect $flags "$program" > out.log 2> err.log
+             echo "status $?" > compile.log
+             cat out.log err.log >> compile.log
+             if [ -f output.class ]; then cat output.class >> compile.log; fi)
+        done
+        check "server ${name%.java} $flags" "$WORK/local/compile.log" "$WORK/remote/compile.log"
+    done
+done
+
+# Bytecode the verifier must reject: the interpreter must print the file's .expected
+# message and exit with the status on its last line.
+for class in "$TEST_DIR"/bytecode/*.class; do
+    name=$(basename "$class" .class)
+    "$INTERPRETER" "$class" > "$WORK/run.log" 2>&1
+    echo "status $?" >> "$WORK/run.log"
+    check "bytecode/$name" "$TEST_DIR/bytecode/$name.expected" "$WORK/run.log"
+done
+# Batch runs: the programs in batch.manifest, compiled plain, run with --batch on several
+# threads. The results must come back in manifest order with the status, error and
+# output a separate run would give; counters and times are left out of the comparison.
+mkdir "$WORK/batch"
+while read -r entry; do
+    name=$(basename "$entry")
+    case $entry in
+    *.java) name=${name%.java}.class
+            (cd "$WORK/batch" && "$COMPILER" "$TEST_DIR/$entry" > compile.log 2>&1 &&
+             mv output.class "$name") ;;
+    *) cp "$TEST_DIR/$entry" "$WORK/batch/" 2> /dev/null ;;
+    esac
+    echo "$name" >> "$WORK/batch/manifest"
+done < "$TEST_DIR/batch.manifest"
+(cd "$WORK/batch" && "$INTERPRETER" --batch=manifest --jobs=4 $(cat "$TEST_DIR/batch.vmargs") 2> /dev/null |
+ sed 's/"instructions":[^,]*,"heap_bytes":[^,]*,"load_s":[^,]*,"run_s":[^,]*,//' > results.jsonl)
+check "batch" "$TEST_DIR/batch.expected" "$WORK/batch/results.jsonl"
+[ $failures -eq 0 ]
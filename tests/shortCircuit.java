@@ -0,0 +1,38 @@
+// && and || evaluate their right operand only when the left one does not decide the result,
+// so its side effects happen only then.
+public class ShortCircuit {
+    public static void main(String[] a) {
+        System.out.println(new S().run());
+    }
+}
+class S {
+    int calls;
+    public boolean t() {
+        calls = calls + 1;
+        return true;
+    }
+    public boolean f() {
+        calls = calls + 10;
+        return false;
+    }
+    public int run() {
+        boolean b;
+        calls = 0;
+        if ((this.f()) && (this.t())) System.out.println(1); else System.out.println(0);
+        System.out.println(calls);
+        calls = 0;
+        if ((this.t()) || (this.f())) System.out.println(1); else System.out.println(0);
+        System.out.println(calls);
+        calls = 0;
+        b = ((this.t()) && (this.f())) || (this.t());
+        if (b) System.out.println(1); else System.out.println(0);
+        System.out.println(calls);
+        calls = 0;
+        while ((calls < 30) && (this.t())) { }
+        System.out.println(calls);
+        calls = 0;
+        b = !((this.f()) || (this.f()));
+        if (b) System.out.println(1); else System.out.println(0);
+        return calls;
+    }
+}
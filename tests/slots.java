@@ -0,0 +1,23 @@
+// Variables share frame slots only when they are never live at the same time. A variable read
+// before it is assigned reads 0, so it must not share a slot with one written earlier.
+public class Slots {
+    public static void main(String[] a) {
+        System.out.println(new S().run(5));
+    }
+}
+class S {
+    public int run(int n) {
+        int a; int b; int c; int i;
+        a = n * 7;
+        System.out.println(a);
+        i = 0;
+        while (i < n) {
+            System.out.println(b);
+            b = i;
+            i = i + 1;
+        }
+        System.out.println(c);
+        c = 3;
+        return c;
+    }
+}
@@ -0,0 +1,46 @@
+// Self-recursive tail calls run in one frame (the test runs with --max-depth=50). The
+// arguments are all evaluated before any parameter is reassigned, so swapping parameters
+// or passing one parameter in two places must see the old values.
+public class TailCall {
+    public static void main(String[] a) {
+        System.out.println(new T().gcd(1071, 462));
+        System.out.println(new T().swap(1000, 1, 2));
+        System.out.println(new T().swap(1001, 1, 2));
+        System.out.println(new T().alias(10, 1, 0));
+        System.out.println(new T().sum(100000, 0));
+        System.out.println(new T().rotate(301, 1, 2, 3));
+        System.out.println(new T().fib(20));
+    }
+}
+class T {
+    public int gcd(int a, int b) {
+        int r;
+        if (b == 0) r = a; else if (a < b) r = this.gcd(b, a); else r = this.gcd(a - b, b);
+        return r;
+    }
+    public int swap(int n, int x, int y) {
+        int r;
+        if (n < 1) r = (x * 10) + y; else r = this.swap(n - 1, y, x);
+        return r;
+    }
+    public int alias(int n, int x, int y) {
+        int r;
+        if (n < 1) r = (x * 1000) + y; else r = this.alias(n - 1, x + y, x);
+        return r;
+    }
+    public int sum(int n, int acc) {
+        int r;
+        if (n < 1) r = acc; else r = this.sum(n - 1, acc + n);
+        return r;
+    }
+    public int rotate(int n, int x, int y, int z) {
+        int r;
+        if (n < 1) r = ((x * 100) + (y * 10)) + z; else r = this.rotate(n - 1, z, x, y);
+        return r;
+    }
+    public int fib(int n) {
+        int r;
+        if (n < 2) r = n; else r = (this.fib(n - 1)) + (this.fib(n - 2));
+        return r;
+    }
+}
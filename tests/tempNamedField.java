@@ -0,0 +1,7 @@
+// A field whose name starts like the compiler's temps: its writes must reach the object.
+public class TempNamedField { public static void main(String[] a) { System.out.println(new C().run(4)); } }
+class C {
+    int _tx;
+    public int set(int v) { _tx = v; return 0; }
+    public int run(int n) { int r; r = this.set(n * 10); return _tx + 1; }
+}